@@ -1,5 +1,5 @@
 // ------------------------------------------------------ -*- C++ -*-
-//     RK.h         by S.Zenitani     last updated : 1999/05/24 
+//     RK.h         by S.Zenitani     last updated : 2026/10/19 
 // ------------------------------------------------------------------
 //   invariant matrix for 4/6th order Runge-Kutta Method
 
@@ -88,46 +88,74 @@ const double st76[7][7] = {
 };
 
 
+// Gauss-Legendre (implicit) Runge-Kutta methods
+//   gl22 : implicit midpoint rule, 2nd order
+//   gl33 : 2-stage Gauss-Legendre, 4th order
+//   the last column is the node, the last row is the weight.
+//   Stages are solved by fixed-point iteration, which converges
+//   for h*L < 1 ( L: Lipschitz constant of the force ).
+
+const double gl22[2][2] = {
+  { 0.5, 0.5 },
+  { 1.0, 1.0 }
+};
+
+const double gl33[3][3] = {
+  {
+    0.25,
+    -0.038675134594812882255,
+    0.21132486540518711775
+  },
+  {
+    0.53867513459481288225,
+    0.25,
+    0.78867513459481288225
+  },
+  {
+    0.5,
+    0.5,
+    1.0
+  }
+};
+
+// fixed-point iteration for the implicit stages, until the relative
+// change is below gl_eps or stops decreasing
+const int    gl_itmax = 50;
+const double gl_eps   = 1.0e-12;
+
+
 vector3 f( const vector3&, const double& );
 double  f( const double& , const double& );
 
 
-void RK4( vector3& y, vector3 (*f)( const vector3&, const double& ),
+inline void RK4( vector3& y, vector3 (*f)( const vector3&, const double& ),
 	  double& x, const double& h )
 {
-  static int i,j;
-  static vector3 k[4];
-  static vector3 tmp;
+  int i;
+  vector3 k[4];
+  vector3 tmp;
 
   // k1
   k[0] = f( y, x );
   
   // k2 ... k4
   for( i=0; i<3; i++ ){
-    tmp = st44[i][0] * k[0];
-    for( j=1; j<(i+1); j++ ){
-      tmp += st44[i][j] * k[j];
-    }
-    k[i+1] = f( y+tmp*h, x+st44[i][3]*h );
-  }
-  
-  tmp = st44[3][0] * k[0];
-  for( j=1; j<4; j++ ){
-    tmp += st44[3][j] * k[j];
+    tmp.set( y, h, st44[i], k, i+1 );
+    k[i+1] = f( tmp, x+st44[i][3]*h );
   }
 
   x += h;
-  y += tmp*h;
+  y.madd( h, st44[3], k, 4 );
   return;
 
 }
 
-void RK4( double& y, double (*f)( const double&, const double& ),
+inline void RK4( double& y, double (*f)( const double&, const double& ),
 	  double& x, const double& h )
 {
-  static int i,j;
-  static double k[4];
-  static double tmp;
+  int i,j;
+  double k[4];
+  double tmp;
 
   // k1
   k[0] = f( y, x );
@@ -153,43 +181,35 @@ void RK4( double& y, double (*f)( const double&, const double& ),
 }
 
 
-void RK6( vector3& y, vector3 (*f)( const vector3, const double& ),
+inline void RK6( vector3& y, vector3 (*f)( const vector3, const double& ),
 	  double& x, const double& h )
 {
-  static int i,j;
-  static vector3 k[7];
-  static vector3 tmp;
+  int i;
+  vector3 k[7];
+  vector3 tmp;
   
   // k1
   k[0] = f( y, x );
 
   // k2 ... k7
   for( i=0; i<6; i++ ){
-    tmp = st76[i][0] * k[0];
-    for( j=1; j<(i+1); j++ ){
-      tmp += st76[i][j] * k[j];
-      }
-    k[i+1] = f( y+tmp*h, x+st76[i][6]*h );
-  }
-  
-  tmp = st76[6][0] * k[0];
-  for( j=1; j<7; j++ ){
-    tmp += st76[6][j] * k[j];
+    tmp.set( y, h, st76[i], k, i+1 );
+    k[i+1] = f( tmp, x+st76[i][6]*h );
   }
 
   x += h;
-  y += tmp*h;
+  y.madd( h, st76[6], k, 7 );
   return;
 
 }
 
 
-void RK6( double& y, double (*f)( const double&, const double& ),
+inline void RK6( double& y, double (*f)( const double&, const double& ),
 	  double& x, const double& h )
 {
-  static int i,j;
-  static double k[7];
-  static double tmp;
+  int i,j;
+  double k[7];
+  double tmp;
   
   // k1
   k[0] = f( y, x );
@@ -214,6 +234,68 @@ void RK6( double& y, double (*f)( const double&, const double& ),
 
 }
 
+inline void GL4( vector3& y, vector3 (*f)( const vector3&, const double& ),
+	  double& x, const double& h )
+{
+  int i,it;
+  vector3 k[2];
+  vector3 tmp, knew;
+  double err, norm;
+
+  // initial guess
+  k[0] = f( y, x );
+  k[1] = k[0];
+
+  for( it=0; it<gl_itmax; it++ ){
+    err = 0.0;
+    norm = 0.0;
+    for( i=0; i<2; i++ ){
+      tmp  = gl33[i][0] * k[0] + gl33[i][1] * k[1];
+      knew = f( y+tmp*h, x+gl33[i][2]*h );
+      err  += ( knew - k[i] ).abs2();
+      norm += knew.abs2();
+      k[i] = knew;
+    }
+    if( err <= gl_eps*gl_eps*norm ) break;
+  }
+
+  x += h;
+  y += ( gl33[2][0] * k[0] + gl33[2][1] * k[1] ) * h;
+  return;
+
+}
+
+inline void GL4( double& y, double (*f)( const double&, const double& ),
+	  double& x, const double& h )
+{
+  int i,it;
+  double k[2];
+  double tmp, knew;
+  double err, norm;
+
+  // initial guess
+  k[0] = f( y, x );
+  k[1] = k[0];
+
+  for( it=0; it<gl_itmax; it++ ){
+    err = 0.0;
+    norm = 0.0;
+    for( i=0; i<2; i++ ){
+      tmp  = gl33[i][0] * k[0] + gl33[i][1] * k[1];
+      knew = f( y+tmp*h, x+gl33[i][2]*h );
+      err  += ( knew - k[i] ) * ( knew - k[i] );
+      norm += knew * knew;
+      k[i] = knew;
+    }
+    if( err <= gl_eps*gl_eps*norm ) break;
+  }
+
+  x += h;
+  y += ( gl33[2][0] * k[0] + gl33[2][1] * k[1] ) * h;
+  return;
+
+}
+
 # endif
 
 // end
@@ -0,0 +1,338 @@
+//  -*- C++ -*-
+//  multi-trajectory attractor engine           last updated : 2026/10/19
+
+//
+//  Copyright (C) 2026
+//             Seiji Zenitani <zenitani@gmail.com>
+//
+//  You may copy, use, modify and redistribute this code
+//  for ANY PURPOSE, without significant change, as long as
+//  all copyright notice are retained.
+//  The author provides this code `as is', and declares that
+//  there is no warranty for it.
+//
+//
+// *** History ***
+//
+// 2026/10/19  Ver 0.1   lanes of trajectories with in-situ statistics
+//
+
+// *** Notice ***
+//
+//   RK.h is required.
+//
+//   attractor<M> integrates many initial conditions of an autonomous
+//   ODE dy/dt = M( y ) with the Runge-Kutta tableaux of RK.h.  The
+//   model M is a class with
+//
+//      static const int dim;                          // dimension
+//      void operator()( const double* y, double* dydt ) const;
+//
+//   Trajectories are advanced in blocks of attractor_lanes lanes
+//   ( y[dim][lanes] ): the stage sums and the update loop over lanes
+//   ( vectorizable ), and the model is called lane by lane.  Blocks
+//   run in parallel with OpenMP.  Nothing is written per
+//   trajectory; after ntrans transient steps each step is accumulated
+//   into per-thread histograms, merged at the end of run():
+//
+//     measure : invariant measure projected on ( y[ia], y[ib] )
+//     retmap  : return map ( w_n, w_n+1 ) of w = y[iw] at the section
+//               y[is] = sec, crossed upward
+//     rtime   : return time between successive section crossings
+//
+//   run( nic, init ) calls init( ic, y ) for the initial condition
+//   number ic = 0 ... nic-1.
+
+
+#ifndef _Z_ATTRACTOR_H_
+#define _Z_ATTRACTOR_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <RK.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+//
+// attractor_histogram class ( 1D: ny = 1 )
+//
+
+class attractor_histogram
+{
+
+protected:
+  int nx, ny;
+  double xlo, xhi, ylo, yhi, sx, sy;
+  long* cnt;
+
+  // not copyable
+  attractor_histogram( const attractor_histogram& );
+  attractor_histogram& operator = ( const attractor_histogram& );
+
+public:
+  long nin, nout;
+
+  // constructor
+  attractor_histogram( void );
+  ~attractor_histogram( void );
+
+  void init( const int&, const double&, const double&,
+             const int& = 1, const double& = 0.0, const double& = 1.0 );
+  void add( const double&, const double& = 0.0 );
+  void merge( const attractor_histogram& );
+  void clear( void );
+
+  long get( const int&, const int& = 0 ) const;
+  void write( FILE* ) const;
+
+};
+
+
+inline attractor_histogram::attractor_histogram( void )
+  : nx(0), ny(0), xlo(0.0), xhi(1.0), ylo(0.0), yhi(1.0),
+    sx(0.0), sy(0.0), cnt(0), nin(0), nout(0) {}
+
+inline attractor_histogram::~attractor_histogram( void ){ free( cnt ); }
+
+inline void attractor_histogram::init( const int& _nx, const double& _xlo,
+                                       const double& _xhi, const int& _ny,
+                                       const double& _ylo, const double& _yhi )
+{
+  nx = _nx;  xlo = _xlo;  xhi = _xhi;
+  ny = _ny;  ylo = _ylo;  yhi = _yhi;
+  sx = nx / ( xhi - xlo );
+  sy = ny / ( yhi - ylo );
+  cnt = (long*) realloc( cnt, sizeof(long) * nx * ny );
+  clear();
+}
+
+inline void attractor_histogram::clear( void )
+{
+  for( int i=0; i<nx*ny; i++ ) cnt[i] = 0;
+  nin = 0;  nout = 0;
+}
+
+inline void attractor_histogram::add( const double& x, const double& y )
+{
+  double fx = ( x - xlo ) * sx;
+  double fy = ( y - ylo ) * sy;
+  // also NaN
+  if( !( fx >= 0.0 && fx < nx && fy >= 0.0 && fy < ny ) ){ nout++; return; }
+  cnt[ int(fy) * nx + int(fx) ]++;
+  nin++;
+}
+
+// h must have the same binning
+inline void attractor_histogram::merge( const attractor_histogram& h )
+{
+  for( int i=0; i<nx*ny; i++ ) cnt[i] += h.cnt[i];
+  nin  += h.nin;
+  nout += h.nout;
+}
+
+inline long attractor_histogram::get( const int& i, const int& j ) const
+{
+  return cnt[ j * nx + i ];
+}
+
+// bin centers and probability density, gnuplot style
+inline void attractor_histogram::write( FILE* fp ) const
+{
+  double norm = ( nin > 0 ? sx * sy / nin : 0.0 );
+  if( ny == 1 ) norm = ( nin > 0 ? sx / nin : 0.0 );
+  for( int j=0; j<ny; j++ ){
+    for( int i=0; i<nx; i++ ){
+      if( ny == 1 )
+        fprintf( fp, "%e %e\n", xlo + (i+0.5)/sx, norm * get(i,j) );
+      else
+        fprintf( fp, "%e %e %e\n", xlo + (i+0.5)/sx, ylo + (j+0.5)/sy,
+                 norm * get(i,j) );
+    }
+    if( ny > 1 ) fprintf( fp, "\n" );
+  }
+}
+
+
+//
+// attractor class
+//
+
+const int attractor_lanes = 64;
+
+template< class M >
+class attractor
+{
+
+protected:
+  struct tally {
+    attractor_histogram measure, retmap, rtime;
+  };
+
+  void binning( tally& ) const;
+  template< int S, class I >
+  void block( const double (&)[S][S], const long&, const int&,
+              I&, tally& ) const;
+
+public:
+  M model;
+
+  // timestep, number of steps, transient steps, order ( 4 or 6 )
+  double h;
+  long nstep, ntrans;
+  int order;
+
+  // projection of the invariant measure
+  int ia, ib, na, nb;
+  double alo, ahi, blo, bhi;
+
+  // section y[is] = sec, recorded coordinate y[iw]
+  int is, iw, nw, nr;
+  double sec, wlo, whi, rmax;
+
+  // results
+  attractor_histogram measure, retmap, rtime;
+
+  // constructor
+  attractor( const M& );
+
+  template< class I >
+  void run( const long&, I& );
+
+};
+
+
+// ---- constructor -----
+
+template< class M >
+inline attractor<M>::attractor( const M& _m )
+  : model(_m), h(0.01), nstep(1000), ntrans(100), order(4),
+    ia(0), ib(1), na(100), nb(100), alo(-1.0), ahi(1.0), blo(-1.0), bhi(1.0),
+    is(0), iw(1), nw(100), nr(100), sec(0.0), wlo(-1.0), whi(1.0), rmax(10.0)
+{
+}
+
+// ---- member functions -----
+
+template< class M >
+inline void attractor<M>::binning( tally& s ) const
+{
+  s.measure.init( na, alo, ahi, nb, blo, bhi );
+  s.retmap.init( nw, wlo, whi, nw, wlo, whi );
+  s.rtime.init( nr, 0.0, rmax );
+}
+
+// integrates nl lanes of initial conditions ic0 ... ic0+nl-1
+template< class M >
+template< int S, class I >
+inline void attractor<M>::block( const double (&st)[S][S], const long& ic0,
+                                 const int& nl, I& init, tally& s ) const
+{
+  const int D = M::dim;
+  const int L = attractor_lanes;
+  double y[D][L], ys[D][L], k[S][D][L];
+  double ps[L], pw[L], wlast[L], tlast[L];
+  int    seen[L];
+  double yl[D], dl[D];
+  int i, j, d, l;
+  long n;
+
+  for( l=0; l<nl; l++ ){
+    init( ic0+l, yl );
+    for( d=0; d<D; d++ ) y[d][l] = yl[d];
+    seen[l] = 0;
+  }
+
+  for( n=0; n<nstep; n++ ){
+    for( l=0; l<nl; l++ ){ ps[l] = y[is][l];  pw[l] = y[iw][l]; }
+
+    // stages
+    for( i=0; i<S; i++ ){
+      for( d=0; d<D; d++ ){
+        for( l=0; l<nl; l++ ) ys[d][l] = 0.0;
+        for( j=0; j<i; j++ ){
+          double a = st[i-1][j];
+          for( l=0; l<nl; l++ ) ys[d][l] += a * k[j][d][l];
+        }
+        for( l=0; l<nl; l++ ) ys[d][l] = y[d][l] + h*ys[d][l];
+      }
+      for( l=0; l<nl; l++ ){
+        for( d=0; d<D; d++ ) yl[d] = ys[d][l];
+        model( yl, dl );
+        for( d=0; d<D; d++ ) k[i][d][l] = dl[d];
+      }
+    }
+
+    // update
+    for( d=0; d<D; d++ ){
+      for( j=0; j<S; j++ ){
+        double a = h * st[S-1][j];
+        for( l=0; l<nl; l++ ) y[d][l] += a * k[j][d][l];
+      }
+    }
+
+    if( n < ntrans ) continue;
+
+    // statistics
+    for( l=0; l<nl; l++ ){
+      s.measure.add( y[ia][l], y[ib][l] );
+
+      double p = ps[l] - sec;
+      double q = y[is][l] - sec;
+      if( p < 0.0 && q >= 0.0 ){
+        double f  = p / ( p - q );
+        double w  = pw[l] + f * ( y[iw][l] - pw[l] );
+        double tc = ( n + f ) * h;
+        if( seen[l] ){
+          s.retmap.add( wlast[l], w );
+          s.rtime.add( tc - tlast[l] );
+        }
+        wlast[l] = w;  tlast[l] = tc;  seen[l] = 1;
+      }
+    }
+  }
+}
+
+template< class M >
+template< class I >
+inline void attractor<M>::run( const long& nic, I& init )
+{
+  const int L = attractor_lanes;
+  long nblock = ( nic + L-1 ) / L;
+  int nt = 1;
+#ifdef _OPENMP
+  nt = omp_get_max_threads();
+#endif
+  tally* loc = new tally[nt];
+  for( int it=0; it<nt; it++ ) binning( loc[it] );
+
+#pragma omp parallel for schedule(dynamic)
+  for( long b=0; b<nblock; b++ ){
+    int it = 0;
+#ifdef _OPENMP
+    it = omp_get_thread_num();
+#endif
+    long ic0 = b * L;
+    int  nl  = int( nic - ic0 < L ? nic - ic0 : L );
+    if( order == 6 ) block<7>( st76, ic0, nl, init, loc[it] );
+    else             block<4>( st44, ic0, nl, init, loc[it] );
+  }
+
+  tally all;
+  binning( all );
+  for( int it=0; it<nt; it++ ){
+    all.measure.merge( loc[it].measure );
+    all.retmap.merge( loc[it].retmap );
+    all.rtime.merge( loc[it].rtime );
+  }
+  delete [] loc;
+
+  measure.init( na, alo, ahi, nb, blo, bhi );  measure.merge( all.measure );
+  retmap.init( nw, wlo, whi, nw, wlo, whi );   retmap.merge( all.retmap );
+  rtime.init( nr, 0.0, rmax );                 rtime.merge( all.rtime );
+}
+
+# endif
+
+// end
@@ -0,0 +1,456 @@
+#include <plugin.h>
+#include <fieldtable.h>
+#include <trajectory.h>
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+
+/* *********************************************************************
+ Accuracy and cost regression check of the particle steppers.
+
+ Three problems with known answers:
+
+  ExB    : E = (0,0.5,0), B = (0,0,1), the field of sample_ExB.cpp.
+           The nonrelativistic orbit is a gyration around the drift
+           E x B / B^2, and the error is the distance from the exact
+           position at t = 50.
+  sheet  : B = (z,0,kappa), the current sheet of sample_poincare.cpp.
+           |v| ( |u| ) and the canonical momentum p_y + q A_y,
+           A_y = kappa x - z^2/2, are conserved; the error is the
+           larger drift of the two at t = 100.
+  well   : E = -r, B = 0, a velocity-independent force ( the only
+           one for sv2 ).  The orbit is r0 cos(t) + v0 sin(t), and
+           the error is the distance from it at t = 50.
+
+ For every stepper and timestep a line of the work-precision table
+ ( stepper, problem, dt, force calls, error, ns/step ) is written
+ to stdout, and the following are checked:
+
+  - the observed order of convergence on ExB ( sv2: on well ),
+  - the error at dt = 0.1 against a bound,
+  - the force calls per step,
+  - the step time in units of one force call ( the overhead ),
+  - the batched ensemble pushes against the scalar ones, in the
+    result ( identical up to rounding ) and in the force calls ( the
+    times are only reported ),
+  - the blocked RK4 and RK6 pushes with a batched force kernel, as
+    made by PPP_PLUGIN ( plugin.h ), against those with F(), bit for
+    bit,
+  - the states of a strided trajectory ( trajectory.h ), which must
+    be those of a trajectory storing every step,
+  - the tabulated field ( fieldtable.h ) of a ring of dipoles, in
+    the error against the tolerance and its own estimate.
+
+ Failures are reported on stderr, and the exit status is nonzero.
+ ********************************************************************* */
+
+// ************* initial parameters ************************************
+// curvature parameter of the sheet
+const double kappa = 0.36178;
+// end times
+const double tend_exb   = 50.0;
+const double tend_sheet = 100.0;
+const double tend_well  = 50.0;
+// ************* initial parameters ************************************
+
+// field selector ( 0: ExB, 1: sheet, 2: well ) and force-call counter
+const int nprob = 3;
+const char* probname[nprob] = { "ExB", "sheet", "well" };
+int  problem = 0;
+long nforce  = 0;
+
+vector3 E( const vector3& _r ){
+  if( problem == 2 ) return -1.0 * _r;
+  vector3 _E( 0.0, ( problem == 0 ? 0.5 : 0.0 ), 0.0 );
+  return _E;
+}
+vector3 B( const vector3& _r ){
+  if( problem == 2 ) return vector3( 0.0, 0.0, 0.0 );
+  vector3 _B( ( problem == 0 ? 0.0 : _r.z ), 0.0,
+              ( problem == 0 ? 1.0 : kappa ) );
+  return _B;
+}
+vector3 F( const vector3& _r, const vector3& _v,
+           const  double& _t, const  double& _q ){
+  nforce++;
+  return _q * ( E(_r) + _v * B(_r) );
+}
+
+// the kernel and entry point a plugin of this F() would export
+PPP_PLUGIN( "bench" )
+
+typedef void (particle::*stepper)( const double& );
+
+// thresholds; the iteration counts of gl2/gl4 and the overheads
+// ( g++ -O2 ) are about 1.5 and 2 times the measured ones
+struct entry
+{
+  const char* name;
+  stepper step;
+  double order;     // nominal order, checked on ExB, else on well
+  // at dt = 0.1, at most ( error < 0: not run )
+  double nf;        // force calls per step
+  double err[nprob];  // ExB, sheet, well error
+  double overhead;  // step time / ( nf * force-call time )
+};
+
+const entry table[] = {
+  { "rk4", &particle::rk4, 4.0,  4.0, { 4e-5,  4e-4,   1e-4   },  7.0 },
+  { "rk6", &particle::rk6, 6.0,  7.0, { 3e-8,  2e-6,   1e-7   },  8.0 },
+  // Stormer-Verlet needs a velocity-independent force
+  { "sv2", &particle::sv2, 2.0,  2.0, { -1.0,  -1.0,   5e-2   },  6.0 },
+  { "gl2", &particle::gl2, 2.0, 16.0, { 4e-2,  1e-12,  1e-1   },  8.0 },
+  { "gl4", &particle::gl4, 4.0, 26.0, { 6e-6,  1e-12,  2e-5   },  8.0 },
+  // no simple exact relativistic ExB or well orbit
+  { "RK4", &particle::RK4, 0.0,  4.0, { -1.0,  3e-4,   -1.0   }, 13.0 },
+  { "RK6", &particle::RK6, 0.0,  7.0, { -1.0,  1.2e-6, -1.0   }, 13.0 },
+};
+const int ntable = sizeof(table) / sizeof(entry);
+const double dts[] = { 0.4, 0.2, 0.1, 0.05 };
+const int ndt = sizeof(dts) / sizeof(double);
+// timings are the best of nrep runs
+const int nrep = 3;
+
+int nfail = 0;
+
+// fails also on NaN
+void check( const char* name, const char* what, const double& val,
+            const double& lim )
+{
+  if( val <= lim ) return;
+  fprintf( stderr, "FAIL %s: %s = %g ( limit %g )\n", name, what, val, lim );
+  nfail++;
+}
+
+double now( void )
+{
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+// initial state of each problem
+void init( particle& p, const int& prob )
+{
+  p.sett(0);  p.setm(1);  p.setq(1);
+  p.setr(0.0,0.0,0.0);
+  if(      prob == 0 ) p.setv(0.3,0.0,0.1);
+  else if( prob == 1 ) p.setv(0.12,-0.15,0.16);
+  else{                p.setr(1.0,0.0,0.0);  p.setv(0.0,0.5,0.2); }
+}
+
+// exact ExB position ( q = m = 1, B = 1 )
+vector3 exb_exact( const double& t )
+{
+  double a = 0.3 - 0.5, b = 0.0;
+  return vector3( 0.5*t + a*sin(t) - b*cos(t) + b,
+                  a*cos(t) - a + b*sin(t), 0.1*t );
+}
+
+// exact well position
+vector3 well_exact( const double& t )
+{
+  return vector3( cos(t), 0.5*sin(t), 0.2*sin(t) );
+}
+
+double sheet_py( const particle& p )
+{
+  return p.v.y + p.getq()/p.getm() * ( kappa*p.r.x - 0.5*p.r.z*p.r.z );
+}
+
+// runs one problem, returns the error; nf and ns per step
+double run( const entry& s, const int& prob, const double& dt,
+            double& nf, double& ns )
+{
+  particle p;
+  problem = prob;
+  const double tend[nprob] = { tend_exb, tend_sheet, tend_well };
+  long nstep = long( tend[prob] / dt + 0.5 );
+  double u0, py0;
+
+  for( int k=0; k<nrep; k++ ){
+    init( p, prob );
+    u0  = p.v.abs();
+    py0 = sheet_py( p );
+    nforce = 0;
+    double t0 = now();
+    for( long i=0; i<nstep; i++ ) (p.*s.step)( dt );
+    double t1 = ( now() - t0 ) * 1e9 / nstep;
+    if( k == 0 || t1 < ns ) ns = t1;
+  }
+  nf = double( nforce ) / nstep;
+
+  if( prob == 0 ) return ( p.r - exb_exact( nstep*dt ) ).abs();
+  if( prob == 2 ) return ( p.r - well_exact( nstep*dt ) ).abs();
+  double de = fabs( p.v.abs() - u0 );
+  double dp = fabs( sheet_py( p ) - py0 );
+  return ( de > dp ? de : dp );
+}
+
+// time of one force call, ns
+double force_time( void )
+{
+  const long n = 10000000;
+  vector3 r( 0.1, 0.2, 0.3 ), v( 0.3, 0.0, 0.1 ), sum;
+  double ns = 0.0;
+  problem = 1;
+  for( int k=0; k<nrep; k++ ){
+    double t0 = now();
+    for( long i=0; i<n; i++ ){
+      sum += F( r, v, 0.0, 1.0 );
+      r.x += 1e-9;
+    }
+    double t1 = ( now() - t0 ) * 1e9 / n;
+    if( k == 0 || t1 < ns ) ns = t1;
+  }
+  // keeps the loop
+  if( sum.x == 1.0 ) printf( "#\n" );
+  return ns;
+}
+
+// batched ensemble pushes against the scalar ones on the sheet, in
+// the result and the force calls; the times are only reported ( the
+// blocked RK4 and RK6 gain little at -O2 on one thread )
+void check_ensemble( void )
+{
+  const int np = 4096;
+  const long nstep = 200;
+  const double dt = 0.1;
+  struct pair {
+    const char* name;
+    stepper step;
+    void (ensemble::*push)( const double& );
+  };
+  const pair pairs[] = {
+    { "ensemble rk6", &particle::rk6, &ensemble::rk6 },
+    { "ensemble RK4", &particle::RK4, &ensemble::RK4 },
+    { "ensemble RK6", &particle::RK6, &ensemble::RK6 },
+  };
+  const int npair = sizeof(pairs) / sizeof(pair);
+
+  problem = 1;
+  for( int k=0; k<npair; k++ ){
+    ensemble e( np );
+    e.setm(1);  e.setq(1);
+    particle p;
+    double tb = 0.0, ts = 0.0, err = 0.0;
+    long nfb = 0, nfs = 0;
+
+    for( int r=0; r<nrep; r++ ){
+      e.clear();
+      for( int i=0; i<np; i++ ){
+        init( p, 1 );
+        p.setr( 0.001*i, 0.0, 0.0 );
+        e.add( p );
+      }
+      nforce = 0;
+      double t0 = now();
+      for( long n=0; n<nstep; n++ ) (e.*pairs[k].push)( dt );
+      double t1 = now() - t0;
+      nfb = nforce;
+      if( r == 0 || t1 < tb ) tb = t1;
+
+      err = 0.0;
+      t1 = 0.0;
+      nforce = 0;
+      for( int i=0; i<np; i++ ){
+        init( p, 1 );
+        p.setr( 0.001*i, 0.0, 0.0 );
+        t0 = now();
+        for( long n=0; n<nstep; n++ ) (p.*pairs[k].step)( dt );
+        t1 += now() - t0;
+        double d = ( e.getr(i) - p.r ).abs() + ( e.getv(i) - p.v ).abs();
+        if( d > err ) err = d;
+      }
+      if( r == 0 || t1 < ts ) ts = t1;
+      nfs = nforce;
+    }
+
+    printf( "# %s: difference %e, time %.3f s ( scalar %.3f s )\n",
+            pairs[k].name, err, tb, ts );
+    check( pairs[k].name, "difference from scalar", err, 1e-10 );
+    check( pairs[k].name, "force calls - scalar ones",
+           fabs( double( nfb - nfs ) ), 0.0 );
+  }
+}
+
+// the blocked pushes with the batched kernel of PPP_PLUGIN against
+// those with F(), on the sheet; the same operations in the same order
+void check_plugin( void )
+{
+  const int np = 1000;
+  const long nstep = 200;
+  const double dt = 0.1;
+  struct pair {
+    const char* name;
+    void (ensemble::*push)( const double& );
+  };
+  const pair pairs[] = {
+    { "plugin RK4", &ensemble::RK4 },
+    { "plugin RK6", &ensemble::RK6 },
+  };
+  const int npair = sizeof(pairs) / sizeof(pair);
+
+  problem = 1;
+  for( int k=0; k<npair; k++ ){
+    ensemble ef( np ), ek( np );
+    ef.setm(1);  ef.setq(1);
+    ek.setm(1);  ek.setq(1);
+    ek.force = ppp_plugin()->force;
+    particle p;
+    for( int i=0; i<np; i++ ){
+      init( p, 1 );
+      p.setr( 0.001*i, 0.0, 0.0 );
+      ef.add( p );
+      ek.add( p );
+    }
+    for( long n=0; n<nstep; n++ ){
+      (ef.*pairs[k].push)( dt );
+      (ek.*pairs[k].push)( dt );
+    }
+
+    double err = 0.0;
+    for( int i=0; i<np; i++ ){
+      double d = ( ek.getr(i) - ef.getr(i) ).abs()
+        + ( ek.getv(i) - ef.getv(i) ).abs() + fabs( ek.t[i] - ef.t[i] );
+      if( !( d <= err ) ) err = d;
+    }
+    printf( "# %s: difference from F() %e\n", pairs[k].name, err );
+    check( pairs[k].name, "difference from F()", err, 0.0 );
+  }
+}
+
+// a strided trajectory against one storing every step, on the sheet;
+// the recomputed steps repeat the recording ones, bit for bit
+void check_trajectory( void )
+{
+  const int stride = 5;
+  const long nstep = 100;
+  const double dt = 0.1;
+  trajectory t1( 128, 1 ), t5( 8, stride, &particle::rk6, dt );
+  particle p, q;
+
+  problem = 1;
+  init( p, 1 );
+  init( q, 1 );
+  for( long n=0; n<nstep; n++ ){
+    t1.record( p );
+    t5.record( p );
+    p.rk6( dt );
+  }
+  double err = 0.0;
+  for( long j=t5.last(); j>=t5.first(); j-- ){
+    t1.get( j, p );
+    t5.get( j, q );
+    double d = ( q.r - p.r ).abs() + ( q.v - p.v ).abs()
+      + fabs( q.gett() - p.gett() );
+    if( !( d <= err ) ) err = d;
+  }
+
+  printf( "# trajectory stride %d: steps %ld ... %ld, difference %e\n",
+          stride, t5.first(), t5.last(), err );
+  check( "trajectory", "difference from stride 1", err, 0.0 );
+}
+
+// a ring of dipoles, as an expensive field to tabulate
+const int nring = 24;
+dipole_field ring[nring];
+
+void ring_field( const vector3& _r, vector3& _E, vector3& _B )
+{
+  _E.set();  _B.set();
+  for( int k=0; k<nring; k++ ) ring[k].add( _r, 0.0, _E, _B );
+}
+
+void check_table( void )
+{
+  const double tol = 1e-6;
+  const long n = 1000000;
+  for( int k=0; k<nring; k++ ){
+    double a = 2.0 * M_PI * k / nring;
+    ring[k] = field_dipole( vector3( 0.0, 0.0, -0.1 ),
+                            vector3( 8.0*cos(a), 8.0*sin(a), 0.0 ), 1.0 );
+  }
+  field_table tab( vector3( -4.0, -4.0, -2.0 ), vector3( 4.0, 4.0, 2.0 ) );
+  double est = tab.build( ring_field, tol );
+  double err = tab.check( ring_field, 100000 );
+
+  // query time, table and direct
+  vector3 r( -3.9, 0.3, 0.2 ), sum, _E, _B;
+  double tt = 0.0, td = 0.0;
+  for( int k=0; k<nrep; k++ ){
+    double t0 = now();
+    for( long i=0; i<n; i++ ){
+      tab.eval( r, 0.0, _E, _B );
+      sum += _B;
+      r.x += 7e-6;  r.z -= 3e-7;
+    }
+    double t1 = now();
+    r.set( -3.9, 0.3, 0.2 );
+    for( long i=0; i<n; i++ ){
+      ring_field( r, _E, _B );
+      sum += _B;
+      r.x += 7e-6;  r.z -= 3e-7;
+    }
+    double t2 = now();
+    r.set( -3.9, 0.3, 0.2 );
+    if( k == 0 || t1 - t0 < tt ) tt = t1 - t0;
+    if( k == 0 || t2 - t1 < td ) td = t2 - t1;
+  }
+  if( sum.x == 1.0 ) printf( "#\n" );
+
+  printf( "# field table: %d patches, %ld bytes, error %e ( estimate %e ),"
+          " %.1f ns ( direct %.1f ns )\n", tab.patches(), tab.bytes(),
+          err, est, tt * 1e9 / n, td * 1e9 / n );
+  check( "field table", "error", err, tol );
+  check( "field table", "error / estimate", err / est, 1.0 );
+}
+
+int main()
+{
+  double tf = force_time();
+  printf( "# force call %.2f ns\n", tf );
+  printf( "# stepper problem dt force_calls error ns/step\n" );
+
+  for( int k=0; k<ntable; k++ ){
+    const entry& s = table[k];
+    double err[nprob][ndt], nf[nprob][ndt], ns[nprob][ndt];
+
+    for( int prob=0; prob<nprob; prob++ ){
+      if( s.err[prob] < 0.0 ) continue;
+      for( int j=0; j<ndt; j++ ){
+        err[prob][j] = run( s, prob, dts[j], nf[prob][j], ns[prob][j] );
+        printf( "%s %s %g %g %e %.1f\n", s.name, probname[prob],
+                dts[j], nf[prob][j], err[prob][j], ns[prob][j] );
+      }
+      printf( "\n\n" );
+    }
+
+    // at dt = dts[2] = 0.1, the order from the two finest timesteps,
+    // cost on the first problem run
+    int p0 = 0;
+    while( s.err[p0] < 0.0 ) p0++;
+    check( s.name, "force calls per step", nf[p0][2], s.nf );
+    check( s.name, "overhead", ns[p0][2] / ( nf[p0][2] * tf ), s.overhead );
+    for( int prob=0; prob<nprob; prob++ ){
+      if( s.err[prob] < 0.0 ) continue;
+      char what[64];
+      snprintf( what, sizeof(what), "%s error", probname[prob] );
+      check( s.name, what, err[prob][2], s.err[prob] );
+    }
+    // the sheet error is a drift, not a truncation error
+    int po = ( s.err[0] >= 0.0 ? 0 : 2 );
+    if( s.order > 0.0 && s.err[po] >= 0.0 ){
+      double ord = log( err[po][2] / err[po][3] ) / log( dts[2] / dts[3] );
+      check( s.name, "order deficit", s.order - ord, 0.5 );
+    }
+  }
+
+  check_ensemble();
+  check_plugin();
+  check_trajectory();
+  check_table();
+
+  if( nfail > 0 ) fprintf( stderr, "# %d check(s) failed\n", nfail );
+  else            fprintf( stderr, "# all checks passed\n" );
+  return ( nfail > 0 ? 1 : 0 );
+}
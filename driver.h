@@ -0,0 +1,443 @@
+//  -*- C++ -*-
+//  coroutine particle driver                   last updated : 2026/10/19
+
+//
+//  Copyright (C) 2026
+//             Seiji Zenitani <zenitani@gmail.com>
+//
+//  You may copy, use, modify and redistribute this code
+//  for ANY PURPOSE, without significant change, as long as
+//  all copyright notice are retained.
+//  The author provides this code `as is', and declares that
+//  there is no warranty for it.
+//
+//
+// *** History ***
+//
+// 2026/10/19  Ver 0.1   batched stepping, event flags, lifecycles
+//
+
+// *** Notice ***
+//
+//   ensemble.h is required, and C++20 ( -std=c++20 ) for coroutines.
+//
+//   A driver advances all particles of an ensemble together by one
+//   of its batched pushes, and replaces the hand-written loop of
+//   every particle by a lifecycle coroutine:
+//
+//     lifecycle orbit( agent a ){        // a must be the 1st argument
+//       for(;;){
+//         event ev = co_await a;         // waits for the next event
+//         if( ev.kind & event_cross ) co_yield ev;   // publishes it
+//         else co_return;                // retires the particle
+//       }
+//     }
+//     drv.add( p, orbit( drv.self() ) );
+//     for( const event& ev : drv.run() ) ...  // published events,
+//                                             // in step order
+//
+//   After each step the stop conditions of all particles are
+//   evaluated in one branch-free pass into event bits:
+//
+//     event_cross    the section n.r = c is crossed; r, v and t of
+//                    the event are interpolated to the section
+//     event_exit     r left the box [lo,hi)
+//     event_tlimit   t >= tmax, or the last of nstep steps
+//     event_dtlimit  ( and event_user ) by the condition functor
+//                    given to run( cond ): int cond( e, i ) returns
+//                    the bits, e.g. when |B| h is too large
+//
+//   Only the particles with an event are resumed, and retired ones
+//   are removed from the ensemble ( see ensemble::remove ) after the
+//   step.  A lifecycle that ignores event_tlimit is resumed in every
+//   later step.  run() needs tmax or nstep, and ends after nstep
+//   steps even if particles are left.
+//
+//   The ensemble must be empty when the driver is made, since every
+//   particle needs its lifecycle; otherwise the driver refuses to
+//   add() and run().
+
+
+#ifndef _Z_DRIVER_H_
+#define _Z_DRIVER_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <coroutine>
+#include <iterator>
+#include <vector3.h>
+#include <ensemble.h>
+
+
+// event bits
+const int event_cross   = 1;
+const int event_exit    = 2;
+const int event_tlimit  = 4;
+const int event_dtlimit = 8;
+const int event_user    = 16;
+
+struct event
+{
+  int kind;
+  long id;
+  double t;
+  vector3 r, v;
+};
+
+class driver;
+
+
+//
+// agent: co_await returns the next event of the particle
+//
+
+class agent
+{
+
+protected:
+  driver* d;
+
+public:
+  agent( driver* _d ) : d(_d) {}
+  driver* owner( void ) const{ return d; }
+
+  bool  await_ready( void ) const{ return false; }
+  void  await_suspend( std::coroutine_handle<> ) const{}
+  event await_resume( void ) const;
+
+};
+
+
+//
+// lifecycle of one particle
+//
+
+class lifecycle
+{
+
+public:
+  struct promise_type
+  {
+    driver* d;
+
+    template< class... A >
+    promise_type( const agent& a, const A&... ) : d( a.owner() ) {}
+
+    lifecycle get_return_object( void ){
+      return lifecycle( std::coroutine_handle<promise_type>::from_promise( *this ) );
+    }
+    // runs to the first co_await
+    std::suspend_never  initial_suspend( void ) noexcept{ return {}; }
+    std::suspend_always final_suspend( void ) noexcept{ return {}; }
+    std::suspend_never  yield_value( const event& );
+    void return_void( void ){}
+    void unhandled_exception( void ){ abort(); }
+  };
+  typedef std::coroutine_handle<promise_type> handle;
+
+  handle h;
+  explicit lifecycle( handle _h ) : h(_h) {}
+
+};
+
+
+//
+// event_stream: generator of the published events
+//
+
+class event_stream
+{
+
+public:
+  struct promise_type
+  {
+    const event* cur;
+
+    event_stream get_return_object( void ){
+      return event_stream( std::coroutine_handle<promise_type>::from_promise( *this ) );
+    }
+    std::suspend_always initial_suspend( void ) noexcept{ return {}; }
+    std::suspend_always final_suspend( void ) noexcept{ return {}; }
+    std::suspend_always yield_value( const event& ev ){ cur = &ev;  return {}; }
+    void return_void( void ){}
+    void unhandled_exception( void ){ abort(); }
+  };
+  typedef std::coroutine_handle<promise_type> handle;
+
+  struct iterator
+  {
+    handle h;
+    const event& operator * ( void ) const{ return *h.promise().cur; }
+    iterator& operator ++ ( void ){ h.resume();  return *this; }
+    bool operator != ( std::default_sentinel_t ) const{ return !h.done(); }
+  };
+
+  explicit event_stream( handle _h ) : h(_h) {}
+  event_stream( event_stream&& s ) : h(s.h) { s.h = handle(); }
+  ~event_stream( void ){ if( h ) h.destroy(); }
+
+  iterator begin( void ){ h.resume();  return iterator{ h }; }
+  std::default_sentinel_t end( void ) const{ return std::default_sentinel; }
+
+protected:
+  handle h;
+
+  // not copyable
+  event_stream( const event_stream& );
+  event_stream& operator = ( const event_stream& );
+
+};
+
+
+//
+// driver class
+//
+
+// no condition
+struct no_condition
+{
+  int operator()( const ensemble&, const int& ) const{ return 0; }
+};
+
+class driver
+{
+
+  friend class agent;
+  friend struct lifecycle::promise_type;
+
+protected:
+  ensemble& e;
+  int nq, nqmax;
+  double *px, *py, *pz, *pvx, *pvy, *pvz, *pt;
+  int *flag, *list;
+  lifecycle::handle* life;
+  event  cur;
+  event* queue;
+
+  // not copyable
+  driver( const driver& );
+  driver& operator = ( const driver& );
+
+  void publish( const event& );
+  void retire( const int& );
+  template< class C >
+  void flags( C&, const int&, const int& );
+  template< class C >
+  void batch( C&, const int& );
+
+public:
+  // timestep, batched push
+  double h;
+  void (ensemble::*step)( const double& );
+
+  // stop conditions; tmax or nstep is required
+  int section, box;
+  vector3 normal, lo, hi;
+  double offset, tmax;
+  long nstep;
+
+  // constructor
+  driver( ensemble& );
+  ~driver( void );
+
+  agent self( void );
+  int  add( const particle&, const lifecycle& );
+  int  size( void ) const;
+
+  template< class C >
+  event_stream run( C );
+  event_stream run( void );
+
+};
+
+
+// ---- agent and lifecycle -----
+
+inline event agent::await_resume( void ) const{ return d->cur; }
+
+inline std::suspend_never lifecycle::promise_type::yield_value( const event& ev )
+{
+  d->publish( ev );
+  return {};
+}
+
+
+// ---- constructor -----
+
+// tmax = 1e300 and nstep = 0: no limit
+inline driver::driver( ensemble& _e )
+  : e(_e), nq(0), nqmax(0), px(0), flag(0), life(0), queue(0),
+    h(0.01), step(&ensemble::rk4), section(0), box(0),
+    normal(0.0,0.0,1.0), offset(0.0), tmax(1e300), nstep(0)
+{
+  lo.set();  hi.set();
+  if( e.size() > 0 ){
+    fprintf( stderr, "driver: the ensemble must be empty ( %d particles )\n",
+             e.size() );
+    return;
+  }
+  int nmax = e.capacity();
+  px   = (double*) malloc( sizeof(double) * 7 * nmax );
+  flag = (int*) malloc( sizeof(int) * 2 * nmax );
+  life = (lifecycle::handle*) malloc( sizeof(lifecycle::handle) * nmax );
+  if( !px || !flag || !life ){
+    fprintf( stderr, "driver: cannot allocate %d particles\n", nmax );
+    free( px );  free( flag );  free( life );
+    px = 0;  flag = 0;  life = 0;
+    return;
+  }
+  py   = px + nmax;    pz  = py  + nmax;
+  pvx  = pz + nmax;    pvy = pvx + nmax;
+  pvz  = pvy + nmax;   pt  = pvz + nmax;
+  list = flag + nmax;
+  for( int i=0; i<nmax; i++ ) new( life + i ) lifecycle::handle();
+}
+
+inline driver::~driver( void )
+{
+  if( life )
+    for( int i=0; i<e.size(); i++ ) if( life[i] ) life[i].destroy();
+  free( px );  free( flag );  free( life );  free( queue );
+}
+
+// ---- member functions -----
+
+inline agent driver::self( void ){ return agent( this ); }
+inline int driver::size( void ) const{ return e.size(); }
+
+// the driver owns the lifecycle from now on; returns the index or -1
+inline int driver::add( const particle& p, const lifecycle& l )
+{
+  if( !life ){
+    l.h.destroy();
+    return -1;
+  }
+  int i = e.add( p );
+  if( i < 0 || l.h.done() ){
+    if( i >= 0 ) e.remove( i );
+    l.h.destroy();
+    return -1;
+  }
+  life[i] = l.h;
+  return i;
+}
+
+inline void driver::publish( const event& ev )
+{
+  if( nq >= nqmax ){
+    nqmax = ( nqmax > 0 ? 2*nqmax : 256 );
+    queue = (event*) realloc( queue, sizeof(event) * nqmax );
+  }
+  queue[nq++] = ev;
+}
+
+inline void driver::retire( const int& i )
+{
+  int last = e.size() - 1;
+  life[i].destroy();
+  e.remove( i );
+  life[i] = life[last];
+}
+
+// event bits of the last step
+template< class C >
+inline void driver::flags( C& cond, const int& n, const int& last )
+{
+  STATS_TIMER( STATS_EVENT );
+  const double nx = normal.x, ny = normal.y, nz = normal.z;
+#pragma omp parallel for
+  for( int i=0; i<n; i++ ){
+    double s0 = nx*px[i]  + ny*py[i]  + nz*pz[i]  - offset;
+    double s1 = nx*e.x[i] + ny*e.y[i] + nz*e.z[i] - offset;
+    int out = ( e.x[i] < lo.x ) | ( e.x[i] >= hi.x )
+            | ( e.y[i] < lo.y ) | ( e.y[i] >= hi.y )
+            | ( e.z[i] < lo.z ) | ( e.z[i] >= hi.z );
+    flag[i] = event_cross  * ( section & ( s0*s1 < 0.0 ) )
+            | event_exit   * ( box & out )
+            | event_tlimit * ( ( e.t[i] >= tmax ) | last )
+            | cond( e, i );
+  }
+}
+
+// one step of all particles
+template< class C >
+inline void driver::batch( C& cond, const int& last )
+{
+  int n = e.size();
+  int i, k, nl;
+
+  memcpy( px,  e.x,  sizeof(double) * n );
+  memcpy( py,  e.y,  sizeof(double) * n );
+  memcpy( pz,  e.z,  sizeof(double) * n );
+  memcpy( pvx, e.vx, sizeof(double) * n );
+  memcpy( pvy, e.vy, sizeof(double) * n );
+  memcpy( pvz, e.vz, sizeof(double) * n );
+  memcpy( pt,  e.t,  sizeof(double) * n );
+
+  {
+    STATS_TIMER( STATS_PUSH );
+    (e.*step)( h );
+  }
+
+  flags( cond, n, last );
+
+  // the particles with events
+  nl = 0;
+  for( i=0; i<n; i++ ){
+    list[nl] = i;
+    nl += ( flag[i] != 0 );
+  }
+
+  for( k=0; k<nl; k++ ){
+    i = list[k];
+    cur.kind = flag[i];
+    cur.id   = e.id[i];
+    if( flag[i] & event_cross ){
+      double s0 = normal.x*px[i]  + normal.y*py[i]  + normal.z*pz[i]  - offset;
+      double s1 = normal.x*e.x[i] + normal.y*e.y[i] + normal.z*e.z[i] - offset;
+      double w  = 1.0 / ( s1 - s0 );
+      cur.t = ( s1*pt[i] - s0*e.t[i] ) * w;
+      cur.r.set( ( s1*px[i] - s0*e.x[i] ) * w, ( s1*py[i] - s0*e.y[i] ) * w,
+                 ( s1*pz[i] - s0*e.z[i] ) * w );
+      cur.v.set( ( s1*pvx[i] - s0*e.vx[i] ) * w, ( s1*pvy[i] - s0*e.vy[i] ) * w,
+                 ( s1*pvz[i] - s0*e.vz[i] ) * w );
+    }else{
+      cur.t = e.t[i];
+      cur.r = e.getr(i);
+      cur.v = e.getv(i);
+    }
+    life[i].resume();
+  }
+
+  // from the tail, so that remove() only moves living particles
+  for( k=nl-1; k>=0; k-- ){
+    i = list[k];
+    if( life[i].done() ) retire( i );
+  }
+}
+
+template< class C >
+inline event_stream driver::run( C cond )
+{
+  if( !life ) co_return;
+  if( tmax >= 1e300 && nstep <= 0 ){
+    fprintf( stderr, "driver: run() needs tmax or nstep\n" );
+    co_return;
+  }
+  for( long n=0; e.size() > 0 && ( nstep <= 0 || n < nstep ); n++ ){
+    nq = 0;
+    batch( cond, n == nstep-1 );
+    for( int k=0; k<nq; k++ ) co_yield queue[k];
+  }
+}
+
+inline event_stream driver::run( void )
+{
+  return run( no_condition() );
+}
+
+# endif
+
+// end
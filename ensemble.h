@@ -0,0 +1,437 @@
+//  -*- C++ -*-
+//  particle ensemble ( structure of arrays )   last updated : 2026/10/19
+
+//
+//  Copyright (C) 2026
+//             Seiji Zenitani <zenitani@gmail.com>
+//
+//  You may copy, use, modify and redistribute this code
+//  for ANY PURPOSE, without significant change, as long as
+//  all copyright notice are retained.
+//  The author provides this code `as is', and declares that
+//  there is no warranty for it.
+//
+//
+// *** History ***
+//
+// 2026/10/19  Ver 0.1   arena-backed pool with injection and removal
+//                       blocked relativistic RK4(), RK6()
+//                       batched force kernel ( e.g. from plugin.h )
+//
+
+// *** Notice ***
+//
+//   particle.h is required.
+//
+//   An ensemble holds up to nmax particles of one species (m,q) in
+//   a structure of arrays x[], y[], z[], vx[], vy[], vz[], t[], id[].
+//   All arrays live in one arena allocated at construction, so
+//   injection and removal never allocate.  The active particles are
+//   always 0 ... size()-1: remove() moves the last particle into the
+//   hole, so the order of particles is NOT preserved.  Use id[] to
+//   follow a particle.
+//
+//   inject( count, source, t ) calls source( r, v ) for each new
+//   particle, e.g. a functor sampling a distribution function.
+//
+//   rk4(), rk6(), ... push all particles by the particle:: methods
+//   ( OpenMP parallel if compiled with -fopenmp ).
+//   RK4() and RK6() ( relativistic ) work on blocks of particles in
+//   SoA stage arrays, and evaluate 1/gamma of all stages in a
+//   vectorizable loop by ppp_rsqrt().  If the member force is set to
+//   a batched kernel ( see ppp_force_kernel ), they call it once per
+//   block and stage instead of F() per particle.
+
+
+#ifndef _Z_ENSEMBLE_H_
+#define _Z_ENSEMBLE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector3.h>
+#include <particle.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+//
+// OpenMP thread queries ( serial fallback )
+//
+
+inline int ppp_num_threads( void )
+{
+#ifdef _OPENMP
+  return omp_get_num_threads();
+#else
+  return 1;
+#endif
+}
+inline int ppp_thread_num( void )
+{
+#ifdef _OPENMP
+  return omp_get_thread_num();
+#else
+  return 0;
+#endif
+}
+inline int ppp_max_threads( void )
+{
+#ifdef _OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+
+// 1/sqrt(x), x >= 1 : single-precision seed and two Newton steps
+// ( ~1 ulp in double, vectorizable without -ffast-math )
+inline double ppp_rsqrt( const double& x )
+{
+  double y = double( 1.0f / sqrtf( float(x) ) );
+  y *= 1.5 - 0.5*x*y*y;
+  y *= 1.5 - 0.5*x*y*y;
+  return y;
+}
+
+// particles per block in the blocked pushes
+const int ensemble_block = 64;
+
+// Runge-Kutta stage sum of a block, for each of the six components
+// ( r, u ):  y = y0 + h * ( a[0]*kk[0] + ... + a[nj-1]*kk[nj-1] ).
+// The first term starts the sum and the last one is fused with the
+// update, so there are no zeroing and update passes; y0 may be y.
+template< int S >
+inline void ensemble_stage( double* const (&y)[6], double* const (&y0)[6],
+                            const double& h, const double* a, const int& nj,
+                            const double (&kk)[6][S][ensemble_block],
+                            const int& nb )
+{
+  for( int c=0; c<6; c++ ){
+    double* yc = y[c];
+    const double* y0c = y0[c];
+    const double (*kc)[ensemble_block] = kk[c];
+    int j, k;
+    if( nj == 0 ){
+      for( k=0; k<nb; k++ ) yc[k] = y0c[k];
+      continue;
+    }
+    if( nj == 1 ){
+      for( k=0; k<nb; k++ ) yc[k] = y0c[k] + h*( a[0] * kc[0][k] );
+      continue;
+    }
+    double s[ensemble_block];
+    for( k=0; k<nb; k++ ) s[k] = a[0] * kc[0][k];
+    for( j=1; j<nj-1; j++ )
+      for( k=0; k<nb; k++ ) s[k] += a[j] * kc[j][k];
+    for( k=0; k<nb; k++ ) yc[k] = y0c[k] + h*( s[k] + a[nj-1] * kc[nj-1][k] );
+  }
+}
+
+// batched force kernel: f[k] = F( r[k], v[k], t[k], q ), k < n, in SoA
+typedef void (*ppp_force_kernel)( int n, const double* x, const double* y,
+                                  const double* z, const double* vx,
+                                  const double* vy, const double* vz,
+                                  const double* t, double q,
+                                  double* fx, double* fy, double* fz );
+
+
+//
+// ensemble class
+//
+
+class ensemble
+{
+
+protected:
+  double m, q;
+  int n, nmax;
+  long nextid;
+  char* arena;
+
+  // not copyable
+  ensemble( const ensemble& );
+  ensemble& operator = ( const ensemble& );
+
+  template< void (particle::*step)( const double& ) >
+  void push( const double& );
+  template< int S >
+  void rel_push( const double (&)[S][S], const double& );
+
+public:
+  double *x, *y, *z, *vx, *vy, *vz, *t;
+  long   *id;
+
+  // batched force of RK4(), RK6(); 0: F()
+  ppp_force_kernel force;
+
+  // constructor
+  ensemble( const int& );
+  ~ensemble( void );
+
+  // get/set functions
+  double getm( void ) const;
+  double getq( void ) const;
+  void setm( const double& );
+  void setq( const double& );
+  int size( void ) const;
+  int capacity( void ) const;
+
+  vector3 getr( const int& ) const;
+  vector3 getv( const int& ) const;
+  void load( const int&, particle& ) const;
+  void store( const int&, const particle& );
+  void gamma_inv( double* ) const;
+
+  // birth and death
+  int  add( const vector3&, const vector3&, const double& );
+  int  append( const int& );
+  int  add( const particle& );
+  template< class S >
+  int  inject( const int&, S&, const double& );
+  void remove( const int& );
+  template< class C >
+  int  remove_if( C );
+  void clear( void );
+
+  // batched push
+  void rk4( const double& );
+  void rk6( const double& );
+  void RK4( const double& );
+  void RK6( const double& );
+  void sv2( const double& );
+  void gl2( const double& );
+  void gl4( const double& );
+
+};
+
+
+// ---- constructor -----
+
+// every array starts on a 64-byte boundary
+inline ensemble::ensemble( const int& _nmax )
+  : m(1.0), q(0.0), n(0), nmax(_nmax), nextid(0), force(0)
+{
+  const size_t align = 64;
+  size_t nd = ( ( nmax*sizeof(double) + align-1 ) / align ) * align;
+  size_t nl = ( ( nmax*sizeof(long)   + align-1 ) / align ) * align;
+  arena = (char*) malloc( 7*nd + nl + align );
+  if( !arena ){
+    // an empty pool: every add() fails
+    fprintf( stderr, "ensemble: cannot allocate %d particles\n", nmax );
+    nmax = 0;
+    x = y = z = vx = vy = vz = t = 0;  id = 0;
+    return;
+  }
+  char* p = arena + ( align - (uintptr_t)arena % align ) % align;
+
+  x  = (double*)( p + 0*nd );  y  = (double*)( p + 1*nd );
+  z  = (double*)( p + 2*nd );  vx = (double*)( p + 3*nd );
+  vy = (double*)( p + 4*nd );  vz = (double*)( p + 5*nd );
+  t  = (double*)( p + 6*nd );  id = (long*)  ( p + 7*nd );
+}
+
+inline ensemble::~ensemble( void ){ free( arena ); }
+
+// ---- member functions -----
+
+inline double ensemble::getm( void ) const{ return m; }
+inline double ensemble::getq( void ) const{ return q; }
+inline void ensemble::setm( const double& _m ){ m = _m; }
+inline void ensemble::setq( const double& _q ){ q = _q; }
+inline int  ensemble::size( void ) const{ return n; }
+inline int  ensemble::capacity( void ) const{ return nmax; }
+
+inline vector3 ensemble::getr( const int& i ) const
+{
+  return vector3( x[i], y[i], z[i] );
+}
+inline vector3 ensemble::getv( const int& i ) const
+{
+  return vector3( vx[i], vy[i], vz[i] );
+}
+
+// p must have m and q of this ensemble ( see push() )
+inline void ensemble::load( const int& i, particle& p ) const
+{
+  p.sett( t[i] );
+  p.r.set( x[i], y[i], z[i] );
+  p.v.set( vx[i], vy[i], vz[i] );
+}
+inline void ensemble::store( const int& i, const particle& p )
+{
+  t[i] = p.gett();
+  x[i]  = p.r.x;  y[i]  = p.r.y;  z[i]  = p.r.z;
+  vx[i] = p.v.x;  vy[i] = p.v.y;  vz[i] = p.v.z;
+}
+
+// 1/gamma of the 4-velocities ( relativistic )
+inline void ensemble::gamma_inv( double* gi ) const
+{
+#pragma omp parallel for
+  for( int i=0; i<n; i++ )
+    gi[i] = ppp_rsqrt( 1.0 + vx[i]*vx[i] + vy[i]*vy[i] + vz[i]*vz[i] );
+}
+
+// returns the index of the new particle, or -1 if the pool is full
+inline int ensemble::add( const vector3& _r, const vector3& _v,
+                          const double& _t )
+{
+  if( n >= nmax ) return -1;
+  x[n]  = _r.x;  y[n]  = _r.y;  z[n]  = _r.z;
+  vx[n] = _v.x;  vy[n] = _v.y;  vz[n] = _v.z;
+  t[n]  = _t;
+  id[n] = nextid++;
+  return n++;
+}
+inline int ensemble::add( const particle& p )
+{
+  return add( p.r, p.v, p.gett() );
+}
+
+// reserves count slots ( fewer if the pool is full, none if
+// count < 0 ) at the tail with new ids, to be filled by the caller;
+// returns the first index
+inline int ensemble::append( const int& count )
+{
+  int i0 = n;
+  int nc = ( count < nmax-n ? count : nmax-n );
+  if( nc < 0 ) nc = 0;
+  for( int i=0; i<nc; i++ ) id[i0+i] = nextid + i;
+  nextid += nc;
+  n += nc;
+  return i0;
+}
+
+// returns the number of injected particles
+template< class S >
+inline int ensemble::inject( const int& count, S& source, const double& _t )
+{
+  vector3 _r, _v;
+  int k;
+  for( k=0; k<count && n<nmax; k++ ){
+    source( _r, _v );
+    add( _r, _v, _t );
+  }
+  return k;
+}
+
+// O(1) removal: the last particle fills the hole
+inline void ensemble::remove( const int& i )
+{
+  n--;
+  x[i]  = x[n];   y[i]  = y[n];   z[i]  = z[n];
+  vx[i] = vx[n];  vy[i] = vy[n];  vz[i] = vz[n];
+  t[i]  = t[n];   id[i] = id[n];
+}
+
+// removes every particle with cond( *this, i ) == true,
+// returns the number of removed particles
+template< class C >
+inline int ensemble::remove_if( C cond )
+{
+  int n0 = n;
+  int i = 0;
+  while( i < n ){
+    if( cond( *this, i ) ) remove( i );
+    else i++;
+  }
+  return n0 - n;
+}
+
+inline void ensemble::clear( void ){ n = 0; }
+
+
+// ---- batched push ----
+
+template< void (particle::*step)( const double& ) >
+inline void ensemble::push( const double& h )
+{
+#pragma omp parallel
+  {
+    particle p;
+    p.setm( m );  p.setq( q );
+#pragma omp for
+    for( int i=0; i<n; i++ ){
+      load( i, p );
+      (p.*step)( h );
+      store( i, p );
+    }
+  }
+}
+
+// relativistic Runge-Kutta on blocks of particles,
+// same stages as particle::RK4(), RK6()
+template< int S >
+inline void ensemble::rel_push( const double (&st)[S][S], const double& h )
+{
+  const int B = ensemble_block;
+  double m_inv = 1.0 / m;
+
+#pragma omp parallel for
+  for( int b0=0; b0<n; b0+=B ){
+    // slopes and stage values of x, y, z, ux, uy, uz
+    double kk[6][S][B], ys[6][B], gi[B];
+    double (*krx)[B] = kk[0], (*kry)[B] = kk[1], (*krz)[B] = kk[2];
+    double (*kvx)[B] = kk[3], (*kvy)[B] = kk[4], (*kvz)[B] = kk[5];
+    double *rx = ys[0], *ry = ys[1], *rz = ys[2];
+    double *ux = ys[3], *uy = ys[4], *uz = ys[5];
+    double* const Y0[6] = { x+b0, y+b0, z+b0, vx+b0, vy+b0, vz+b0 };
+    double* const YS[6] = { rx, ry, rz, ux, uy, uz };
+    double *T = t+b0;
+    int nb = ( n-b0 < B ? n-b0 : B );
+    int i, k;
+
+    for( i=0; i<S; i++ ){
+      // stage position and 4-velocity
+      ensemble_stage<S>( YS, Y0, h, ( i>0 ? st[i-1] : 0 ), i, kk, nb );
+
+      // one reciprocal square root per particle and stage
+      for( k=0; k<nb; k++ )
+        gi[k] = ppp_rsqrt( 1.0 + ux[k]*ux[k] + uy[k]*uy[k] + uz[k]*uz[k] );
+      for( k=0; k<nb; k++ ){
+        krx[i][k] = gi[k] * ux[k];
+        kry[i][k] = gi[k] * uy[k];
+        krz[i][k] = gi[k] * uz[k];
+      }
+
+      // force
+      double dt = ( i>0 ? st[i-1][S-1]*h : 0.0 );
+      STATS_TIMER( STATS_FIELD );
+      if( force ){
+        for( k=0; k<nb; k++ ) gi[k] = T[k]+dt;   // stage times
+        force( nb, rx, ry, rz, krx[i], kry[i], krz[i], gi, q,
+               kvx[i], kvy[i], kvz[i] );
+        for( k=0; k<nb; k++ ){
+          kvx[i][k] *= m_inv;  kvy[i][k] *= m_inv;  kvz[i][k] *= m_inv;
+        }
+      }else{
+        for( k=0; k<nb; k++ ){
+          vector3 f = m_inv * F( vector3( rx[k], ry[k], rz[k] ),
+                                 vector3( krx[i][k], kry[i][k], krz[i][k] ),
+                                 T[k]+dt, q );
+          kvx[i][k] = f.x;  kvy[i][k] = f.y;  kvz[i][k] = f.z;
+        }
+      }
+    }
+
+    // update
+    ensemble_stage<S>( Y0, Y0, h, st[S-1], S, kk, nb );
+    for( k=0; k<nb; k++ ) T[k] += h;
+    for( k=0; k<nb; k++ ) STATS_STEP( S, h );
+  }
+}
+
+inline void ensemble::rk4( const double& h ){ push<&particle::rk4>( h ); }
+inline void ensemble::rk6( const double& h ){ push<&particle::rk6>( h ); }
+inline void ensemble::RK4( const double& h ){ rel_push<4>( st44, h ); }
+inline void ensemble::RK6( const double& h ){ rel_push<7>( st76, h ); }
+inline void ensemble::sv2( const double& h ){ push<&particle::sv2>( h ); }
+inline void ensemble::gl2( const double& h ){ push<&particle::gl2>( h ); }
+inline void ensemble::gl4( const double& h ){ push<&particle::gl4>( h ); }
+
+# endif
+
+// end
@@ -0,0 +1,237 @@
+//  -*- C++ -*-
+//  analytic field models                       last updated : 2026/10/19
+
+//
+//  Copyright (C) 2026
+//             Seiji Zenitani <zenitani@gmail.com>
+//
+//  You may copy, use, modify and redistribute this code
+//  for ANY PURPOSE, without significant change, as long as
+//  all copyright notice are retained.
+//  The author provides this code `as is', and declares that
+//  there is no warranty for it.
+//
+//
+// *** History ***
+//
+// 2026/10/19  Ver 0.1   uniform, sheets, dipole, X-line, plane wave
+//
+
+// *** Notice ***
+//
+//   vector3.h is required.
+//
+//   Standard electromagnetic fields ( in the units of the samples,
+//   c = 1 ) that add up at compile time:
+//
+//     const auto fld = field_harris( 1.0, 1.0, 0.0, 0.2 )
+//       + field_dipole( vector3(0.0,0.0,-1.0), vector3(0.0,0.0,-20.0) )
+//       + field_wave( vector3(0.0,0.01,0.0), vector3(0.5,0.0,0.0), 0.5 );
+//     vector3 F( const vector3& _r, const vector3& _v,
+//                const double& _t, const double& _q ){
+//       return fld.force( _r, _v, _t, _q );
+//     }
+//
+//   The sum is a type field_sum< field_sum< A, B >, C >, so F() inlines
+//   into one branch-free kernel, for particle:: steppers and for the
+//   batched pushes of ensemble.h alike.  E( r, t ), B( r, t ) return
+//   one field, eval( r, t, E, B ) both.
+//
+//     field_uniform( E, B )
+//     field_harris( B0, L, bg, bn )   B = ( B0 tanh(z/L), bg, bn )
+//     field_sheet( B0, L, bg, bn )    B = ( B0 z/L, bg, bn ), the linear
+//                                     sheet of sample_poincare.cpp
+//     field_dipole( m, r0, a )        B = ( 3(m.n)n - m ) / d^3,
+//                                     d = r - r0, softened as d^2 + a^2
+//                                     ( div B != 0 within a )
+//     field_xline( B0, L, ey, bg )    B = B0 ( z/L, 0, x/L ) + ( 0, bg, 0 ),
+//                                     E = ( 0, ey, 0 ), reconnection
+//                                     rate ey
+//     field_wave( E0, k, w, phi )     E = E0 cos( k.r - w t + phi ),
+//                                     B = k x E / w
+
+
+#ifndef _Z_FIELDS_H_
+#define _Z_FIELDS_H_
+
+#include <math.h>
+#include <vector3.h>
+
+
+//
+// field_model base class ( CRTP ): every model adds its E and B by
+//   void add( const vector3& r, const double& t, vector3& E, vector3& B ) const;
+//
+
+template< class D >
+struct field_model
+{
+  const D& self( void ) const{ return static_cast<const D&>( *this ); }
+
+  void eval( const vector3& r, const double& t, vector3& _E, vector3& _B ) const{
+    _E.set();  _B.set();
+    self().add( r, t, _E, _B );
+  }
+  vector3 E( const vector3& r, const double& t = 0.0 ) const{
+    vector3 _E, _B;
+    eval( r, t, _E, _B );
+    return _E;
+  }
+  vector3 B( const vector3& r, const double& t = 0.0 ) const{
+    vector3 _E, _B;
+    eval( r, t, _E, _B );
+    return _B;
+  }
+  // q ( E + v x B )
+  vector3 force( const vector3& r, const vector3& v,
+                 const double& t, const double& q ) const{
+    vector3 _E, _B;
+    eval( r, t, _E, _B );
+    return q * ( _E + v * _B );
+  }
+};
+
+template< class A, class B >
+struct field_sum : public field_model< field_sum<A,B> >
+{
+  A a;
+  B b;
+  field_sum( const A& _a, const B& _b ) : a(_a), b(_b) {}
+  void add( const vector3& r, const double& t, vector3& _E, vector3& _B ) const{
+    a.add( r, t, _E, _B );
+    b.add( r, t, _E, _B );
+  }
+};
+
+template< class A, class B >
+inline field_sum<A,B> operator + ( const field_model<A>& a,
+                                   const field_model<B>& b )
+{
+  return field_sum<A,B>( a.self(), b.self() );
+}
+
+
+// ---- models ----
+
+struct uniform_field : public field_model<uniform_field>
+{
+  vector3 e, b;
+  void add( const vector3&, const double&, vector3& _E, vector3& _B ) const{
+    _E += e;  _B += b;
+  }
+};
+
+struct harris_field : public field_model<harris_field>
+{
+  double b0, linv, bg, bn;
+  void add( const vector3& r, const double&, vector3&, vector3& _B ) const{
+    _B.x += b0 * tanh( r.z * linv );
+    _B.y += bg;
+    _B.z += bn;
+  }
+};
+
+struct sheet_field : public field_model<sheet_field>
+{
+  double b0, linv, bg, bn;
+  void add( const vector3& r, const double&, vector3&, vector3& _B ) const{
+    _B.x += b0 * linv * r.z;
+    _B.y += bg;
+    _B.z += bn;
+  }
+};
+
+struct dipole_field : public field_model<dipole_field>
+{
+  vector3 m, r0;
+  double a2;
+  void add( const vector3& r, const double&, vector3&, vector3& _B ) const{
+    vector3 d = r - r0;
+    double d2   = d.abs2() + a2;
+    double dinv = 1.0 / sqrt( d2 );
+    double d3   = dinv * dinv * dinv;
+    double md   = 3.0 * ( m % d ) * dinv * dinv;
+    _B.madd( d3 * md, d );
+    _B.madd( -d3, m );
+  }
+};
+
+struct xline_field : public field_model<xline_field>
+{
+  double b0, linv, ey, bg;
+  void add( const vector3& r, const double&, vector3& _E, vector3& _B ) const{
+    _B.x += b0 * linv * r.z;
+    _B.y += bg;
+    _B.z += b0 * linv * r.x;
+    _E.y += ey;
+  }
+};
+
+struct wave_field : public field_model<wave_field>
+{
+  vector3 e0, k, kxe;
+  double w, phi;
+  void add( const vector3& r, const double& t, vector3& _E, vector3& _B ) const{
+    double c = cos( k % r - w*t + phi );
+    _E.madd( c, e0 );
+    _B.madd( c, kxe );
+  }
+};
+
+
+// ---- constructors -----
+
+inline uniform_field field_uniform( const vector3& _E, const vector3& _B )
+{
+  uniform_field f;
+  f.e = _E;  f.b = _B;
+  return f;
+}
+
+inline harris_field field_harris( const double& b0, const double& l,
+                                  const double& bg = 0.0,
+                                  const double& bn = 0.0 )
+{
+  harris_field f;
+  f.b0 = b0;  f.linv = 1.0/l;  f.bg = bg;  f.bn = bn;
+  return f;
+}
+
+inline sheet_field field_sheet( const double& b0, const double& l,
+                                const double& bg = 0.0,
+                                const double& bn = 0.0 )
+{
+  sheet_field f;
+  f.b0 = b0;  f.linv = 1.0/l;  f.bg = bg;  f.bn = bn;
+  return f;
+}
+
+inline dipole_field field_dipole( const vector3& m, const vector3& r0,
+                                  const double& a = 0.0 )
+{
+  dipole_field f;
+  f.m = m;  f.r0 = r0;  f.a2 = a*a;
+  return f;
+}
+
+inline xline_field field_xline( const double& b0, const double& l,
+                                const double& ey = 0.0,
+                                const double& bg = 0.0 )
+{
+  xline_field f;
+  f.b0 = b0;  f.linv = 1.0/l;  f.ey = ey;  f.bg = bg;
+  return f;
+}
+
+inline wave_field field_wave( const vector3& e0, const vector3& k,
+                              const double& w, const double& phi = 0.0 )
+{
+  wave_field f;
+  f.e0 = e0;  f.k = k;  f.w = w;  f.phi = phi;
+  f.kxe = ( 1.0/w ) * ( k * e0 );
+  return f;
+}
+
+# endif
+
+// end
@@ -0,0 +1,376 @@
+//  -*- C++ -*-
+//  tabulated fields on Chebyshev patches       last updated : 2026/10/19
+
+//
+//  Copyright (C) 2026
+//             Seiji Zenitani <zenitani@gmail.com>
+//
+//  You may copy, use, modify and redistribute this code
+//  for ANY PURPOSE, without significant change, as long as
+//  all copyright notice are retained.
+//  The author provides this code `as is', and declares that
+//  there is no warranty for it.
+//
+//
+// *** History ***
+//
+// 2026/10/19  Ver 0.1   adaptive octree of tensor Chebyshev patches
+//
+
+// *** Notice ***
+//
+//   fields.h is required.
+//
+//   A field_table samples a static field in the box [lo,hi) once, and
+//   then serves E and B from polynomials:
+//
+//     field_table tab( lo, hi );                  // degree 3 patches
+//     tab.build( f, 1e-6 );                       // f( r, E, B )
+//     vector3 F( ... ){ return tab.force( _r, _v, _t, _q ); }
+//
+//   f is any function or functor void f( const vector3& r, vector3& E,
+//   vector3& B ), e.g. a lambda around the user's E() and B().  The box
+//   is split as an octree until every patch meets the absolute
+//   tolerance on all six components, or maxdepth is reached.  The
+//   error of a patch is estimated by its highest Chebyshev
+//   coefficients and by the field at its corners and center; error()
+//   returns the largest estimate, and check( f, n ) measures the error
+//   at n random points.  Points outside the box are clamped to it.
+//   build() returns -1 if it runs out of memory; a table that is not
+//   built aborts in its first query.
+//
+//   A field_table is a fields.h model, so it adds to analytic
+//   time-dependent parts ( e.g. table + wave ).  A patch of degree p
+//   ( 1 to 7 ) costs 6 (p+1)^3 multiply-adds per query and 48 (p+1)^3
+//   bytes, so the table pays off only for expensive fields: a ring
+//   of 24 dipoles is served about 1.7 times faster at p = 3 ( see
+//   bench.cpp ), a single tanh or dipole is faster directly.
+
+
+#ifndef _Z_FIELDTABLE_H_
+#define _Z_FIELDTABLE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector3.h>
+#include <fields.h>
+
+
+//
+// field_table class
+//
+
+class field_table : public field_model<field_table>
+{
+
+protected:
+  struct node {
+    vector3 c, w;         // center, 1 / half width
+    int child;            // first of 8 children, or -1
+    int patch;            // leaf: patch index
+  };
+
+  vector3 lo, hi;
+  int p, np3;
+  int nnode, nnmax, npatch, npmax;
+  node* tree;
+  double* coef;           // [patch][p+1][p+1][p+1][6]
+  double errmax;
+  int nomem;
+
+  // not copyable
+  field_table( const field_table& );
+  field_table& operator = ( const field_table& );
+
+  int  newnode( void );
+  void patch( const double*, const double&, const double&, const double&,
+              double* ) const;
+  template< class Fn >
+  void fit( Fn&, const vector3&, const vector3&, double*, double& ) const;
+  template< class Fn >
+  void refine( Fn&, const int&, const vector3&, const vector3&,
+               const double&, const int& );
+
+public:
+  // constructor
+  field_table( const vector3&, const vector3&, const int& = 3 );
+  ~field_table( void );
+
+  template< class Fn >
+  double build( Fn&, const double&, const int& = 6 );
+  template< class Fn >
+  double check( Fn&, const int& ) const;
+
+  void add( const vector3&, const double&, vector3&, vector3& ) const;
+
+  double error( void ) const;
+  int    patches( void ) const;
+  long   bytes( void ) const;
+
+};
+
+
+// ---- constructor -----
+
+inline field_table::field_table( const vector3& _lo, const vector3& _hi,
+                                 const int& _p )
+  : lo(_lo), hi(_hi), p( _p < 1 ? 1 : ( _p > 7 ? 7 : _p ) ),
+    np3( (p+1)*(p+1)*(p+1) ),
+    nnode(0), nnmax(0), npatch(0), npmax(0), tree(0), coef(0), errmax(0.0),
+    nomem(0)
+{
+}
+
+inline field_table::~field_table( void ){ free( tree );  free( coef ); }
+
+// ---- member functions -----
+
+inline double field_table::error( void ) const{ return errmax; }
+inline int    field_table::patches( void ) const{ return npatch; }
+inline long   field_table::bytes( void ) const
+{
+  return (long) nnode * sizeof(node) + (long) npatch * 6 * np3 * sizeof(double);
+}
+
+// returns -1 if out of memory
+inline int field_table::newnode( void )
+{
+  if( nnode >= nnmax ){
+    int n = ( nnmax > 0 ? 2*nnmax : 64 );
+    node* t = (node*) realloc( tree, sizeof(node) * n );
+    if( !t ){ nomem = 1;  return -1; }
+    tree = t;  nnmax = n;
+  }
+  tree[nnode].child = -1;
+  tree[nnode].patch = -1;
+  return nnode++;
+}
+
+// Chebyshev coefficients of f on the box [a,b] into c[6][p+1]^3,
+// and the error estimate of the patch
+template< class Fn >
+inline void field_table::fit( Fn& f, const vector3& a, const vector3& b,
+                              double* c, double& err ) const
+{
+  const int n = p + 1;
+  const double PI = 3.14159265358979323846;
+  double* val = new double[ 6 * np3 ];
+  double* tmp = new double[ 6 * np3 ];
+  double* cm  = new double[ n * n ];
+  double* xm  = new double[ n ];
+  int i, j, k, m, l;
+  vector3 _E, _B;
+
+  // nodes and the DCT matrix
+  for( m=0; m<n; m++ ) xm[m] = cos( PI * ( m + 0.5 ) / n );
+  for( i=0; i<n; i++ )
+    for( m=0; m<n; m++ )
+      cm[ i*n + m ] = ( i == 0 ? 1.0 : 2.0 ) / n * cos( PI * i * ( m + 0.5 ) / n );
+
+  vector3 ctr = 0.5 * ( a + b ), hw = 0.5 * ( b - a );
+  for( i=0; i<n; i++ )
+    for( j=0; j<n; j++ )
+      for( k=0; k<n; k++ ){
+        vector3 r( ctr.x + hw.x * xm[i], ctr.y + hw.y * xm[j], ctr.z + hw.z * xm[k] );
+        f( r, _E, _B );
+        double v[6] = { _E.x, _E.y, _E.z, _B.x, _B.y, _B.z };
+        for( l=0; l<6; l++ ) val[ ( ( l*n + i )*n + j )*n + k ] = v[l];
+      }
+
+  // separable transform along k, j, i
+  for( l=0; l<6; l++ ){
+    double* v = val + l*np3;
+    double* t = tmp + l*np3;
+    for( i=0; i<n; i++ ) for( j=0; j<n; j++ ) for( k=0; k<n; k++ ){
+      double s = 0.0;
+      for( m=0; m<n; m++ ) s += cm[ k*n + m ] * v[ ( i*n + j )*n + m ];
+      t[ ( i*n + j )*n + k ] = s;
+    }
+    for( i=0; i<n; i++ ) for( j=0; j<n; j++ ) for( k=0; k<n; k++ ){
+      double s = 0.0;
+      for( m=0; m<n; m++ ) s += cm[ j*n + m ] * t[ ( i*n + m )*n + k ];
+      v[ ( i*n + j )*n + k ] = s;
+    }
+    for( i=0; i<n; i++ ) for( j=0; j<n; j++ ) for( k=0; k<n; k++ ){
+      double s = 0.0;
+      for( m=0; m<n; m++ ) s += cm[ i*n + m ] * v[ ( m*n + j )*n + k ];
+      c[ ( ( i*n + j )*n + k )*6 + l ] = s;
+    }
+  }
+
+  // error: the highest coefficients ...
+  err = 0.0;
+  for( l=0; l<6; l++ ){
+    double tail = 0.0;
+    for( i=0; i<n; i++ ) for( j=0; j<n; j++ ) for( k=0; k<n; k++ )
+      if( i == p || j == p || k == p ) tail += fabs( c[ ( ( i*n + j )*n + k )*6 + l ] );
+    if( tail > err ) err = tail;
+  }
+  delete [] val;  delete [] tmp;  delete [] cm;  delete [] xm;
+}
+
+template< class Fn >
+inline void field_table::refine( Fn& f, const int& in, const vector3& a,
+                                 const vector3& b, const double& tol,
+                                 const int& depth )
+{
+  if( npatch >= npmax ){
+    int n = ( npmax > 0 ? 2*npmax : 64 );
+    double* t = (double*) realloc( coef, sizeof(double) * 6 * np3 * n );
+    if( !t ){ nomem = 1;  return; }
+    coef = t;  npmax = n;
+  }
+  double err;
+  double* c = coef + (long) npatch * 6 * np3;
+  tree[in].c = 0.5 * ( a + b );
+  tree[in].w.set( 2.0 / ( b.x - a.x ), 2.0 / ( b.y - a.y ), 2.0 / ( b.z - a.z ) );
+  fit( f, a, b, c, err );
+
+  // ... and the field at the corners and the center
+  vector3 _E, _B;
+  double v[6];
+  tree[in].patch = npatch++;
+  for( int q=0; q<9; q++ ){
+    double sx = ( q == 8 ? 0.0 : ( q & 1 ? 1.0 : -1.0 ) );
+    double sy = ( q == 8 ? 0.0 : ( q & 2 ? 1.0 : -1.0 ) );
+    double sz = ( q == 8 ? 0.0 : ( q & 4 ? 1.0 : -1.0 ) );
+    vector3 r( 0.5 * ( a.x + b.x + sx * ( b.x - a.x ) ),
+               0.5 * ( a.y + b.y + sy * ( b.y - a.y ) ),
+               0.5 * ( a.z + b.z + sz * ( b.z - a.z ) ) );
+    f( r, _E, _B );
+    patch( c, sx, sy, sz, v );
+    double d = vector3( v[0] - _E.x, v[1] - _E.y, v[2] - _E.z ).abs()
+             + vector3( v[3] - _B.x, v[4] - _B.y, v[5] - _B.z ).abs();
+    if( d > err ) err = d;
+  }
+
+  if( err <= tol || depth <= 0 ){
+    if( err > errmax ) errmax = err;
+    return;
+  }
+
+  // split into 8, the patch of this node is dropped
+  npatch--;
+  tree[in].patch = -1;
+  int c0 = newnode();
+  for( int q=1; q<8; q++ ) newnode();
+  if( nomem ) return;
+  tree[in].child = c0;
+  vector3 mid = tree[in].c;
+  for( int q=0; q<8; q++ ){
+    vector3 qa( q & 1 ? mid.x : a.x, q & 2 ? mid.y : a.y, q & 4 ? mid.z : a.z );
+    vector3 qb( q & 1 ? b.x : mid.x, q & 2 ? b.y : mid.y, q & 4 ? b.z : mid.z );
+    refine( f, c0 + q, qa, qb, tol, depth-1 );
+    if( nomem ) return;
+  }
+}
+
+// returns the largest error estimate, or -1 if out of memory
+template< class Fn >
+inline double field_table::build( Fn& f, const double& tol,
+                                  const int& maxdepth )
+{
+  nnode = 0;  npatch = 0;  errmax = 0.0;  nomem = 0;
+  int root = newnode();
+  if( root >= 0 ) refine( f, root, lo, hi, tol, maxdepth );
+  if( nomem ){
+    fprintf( stderr, "field_table: out of memory at %d patches\n", npatch );
+    nnode = 0;  npatch = 0;
+    return -1.0;
+  }
+  return errmax;
+}
+
+// largest error at n pseudo-random points in the box
+template< class Fn >
+inline double field_table::check( Fn& f, const int& n ) const
+{
+  double err = 0.0;
+  unsigned long s = 12345;
+  vector3 _E, _B, tE, tB, d = hi - lo;
+  for( int i=0; i<n; i++ ){
+    double u[3];
+    for( int k=0; k<3; k++ ){
+      s = s * 6364136223846793005UL + 1442695040888963407UL;
+      u[k] = ( s >> 11 ) * ( 1.0 / 9007199254740992.0 );
+    }
+    vector3 r( lo.x + d.x*u[0], lo.y + d.y*u[1], lo.z + d.z*u[2] );
+    f( r, _E, _B );
+    tE.set();  tB.set();
+    add( r, 0.0, tE, tB );
+    double e = ( tE - _E ).abs() + ( tB - _B ).abs();
+    if( e > err ) err = e;
+  }
+  return err;
+}
+
+// six independent sums over the weights T_i T_j T_k of n^3 coefficients;
+// n is a template parameter, so that the loops unroll
+template< int n >
+inline void field_table_sum( const double* c, const double* tx,
+                             const double* ty, const double* tz, double* v )
+{
+  double v0 = 0.0, v1 = 0.0, v2 = 0.0, v3 = 0.0, v4 = 0.0, v5 = 0.0;
+  for( int i=0; i<n; i++ )
+    for( int j=0; j<n; j++ ){
+      double wij = tx[i] * ty[j];
+      for( int k=0; k<n; k++, c += 6 ){
+        double w = wij * tz[k];
+        v0 += c[0] * w;  v1 += c[1] * w;  v2 += c[2] * w;
+        v3 += c[3] * w;  v4 += c[4] * w;  v5 += c[5] * w;
+      }
+    }
+  v[0] = v0;  v[1] = v1;  v[2] = v2;  v[3] = v3;  v[4] = v4;  v[5] = v5;
+}
+
+// the 6 components of a patch at the local coordinates [-1,1]^3
+inline void field_table::patch( const double* c, const double& sx,
+                                const double& sy, const double& sz,
+                                double* v ) const
+{
+  double tx[8], ty[8], tz[8];
+  tx[0] = 1.0;  ty[0] = 1.0;  tz[0] = 1.0;
+  tx[1] = sx;   ty[1] = sy;   tz[1] = sz;
+  for( int i=2; i<=p; i++ ){
+    tx[i] = 2.0*sx*tx[i-1] - tx[i-2];
+    ty[i] = 2.0*sy*ty[i-1] - ty[i-2];
+    tz[i] = 2.0*sz*tz[i-1] - tz[i-2];
+  }
+
+  switch( p ){
+  case 1:  field_table_sum<2>( c, tx, ty, tz, v );  break;
+  case 2:  field_table_sum<3>( c, tx, ty, tz, v );  break;
+  case 3:  field_table_sum<4>( c, tx, ty, tz, v );  break;
+  case 4:  field_table_sum<5>( c, tx, ty, tz, v );  break;
+  case 5:  field_table_sum<6>( c, tx, ty, tz, v );  break;
+  case 6:  field_table_sum<7>( c, tx, ty, tz, v );  break;
+  default: field_table_sum<8>( c, tx, ty, tz, v );  break;
+  }
+}
+
+// adds the tabulated E and B at r
+inline void field_table::add( const vector3& r, const double&,
+                              vector3& _E, vector3& _B ) const
+{
+  if( npatch == 0 ){
+    fprintf( stderr, "field_table: queried before a successful build()\n" );
+    abort();
+  }
+  double x = ( r.x < lo.x ? lo.x : ( r.x > hi.x ? hi.x : r.x ) );
+  double y = ( r.y < lo.y ? lo.y : ( r.y > hi.y ? hi.y : r.y ) );
+  double z = ( r.z < lo.z ? lo.z : ( r.z > hi.z ? hi.z : r.z ) );
+  const node* nd = tree;
+  while( nd->child >= 0 )
+    nd = tree + nd->child + ( x >= nd->c.x ) + 2*( y >= nd->c.y ) + 4*( z >= nd->c.z );
+
+  double v[6];
+  patch( coef + (long) nd->patch * 6 * np3, ( x - nd->c.x ) * nd->w.x,
+         ( y - nd->c.y ) * nd->w.y, ( z - nd->c.z ) * nd->w.z, v );
+  _E.x += v[0];  _E.y += v[1];  _E.z += v[2];
+  _B.x += v[3];  _B.y += v[4];  _B.z += v[5];
+}
+
+# endif
+
+// end
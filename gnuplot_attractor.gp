@@ -0,0 +1,31 @@
+# This routine displays the statistics in the "data/attractor.dat" file.
+# To use, run the program in the following way.
+#   $ ./sample_attractor > data/attractor.dat
+# Then, load this routine from the gnuplot.
+#   $ gnuplot
+#   gnuplot> load "gnuplot_attractor.gp"
+
+unset key
+
+file="data/attractor.dat"
+
+set multiplot layout 1,3
+set view map
+set logscale cb
+set size square
+set xlabel "x"
+set ylabel "z"
+splot file index 0 us 1:2:($3>0?$3:1/0) w image
+set xlabel "x_n"
+set ylabel "x_{n+1}"
+splot file index 1 us 1:2:($3>0?$3:1/0) w image
+unset logscale cb
+set size nosquare
+set xlabel "return time"
+set ylabel "PDF"
+plot file index 2 us 1:2 w steps
+unset multiplot
+
+set key
+
+# end
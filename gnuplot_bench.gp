@@ -0,0 +1,41 @@
+# This routine displays the work-precision diagrams in the "data/bench.dat" file.
+# To use, run the program in the following way.
+#   $ ./bench > data/bench.dat
+# Then, load this routine from the gnuplot.
+#   $ gnuplot
+#   gnuplot> load "gnuplot_bench.gp"
+#
+# Error against force calls per unit time, ExB (left), current sheet (center)
+# and harmonic well (right).
+
+file="data/bench.dat"
+
+set multiplot layout 1,3
+set logscale xy
+set format y "10^{%L}"
+set xlabel "force calls / time"
+set ylabel "error"
+set title "ExB"
+plot file index 0  us ($4/$3):5 w lp t "rk4", \
+     file index 3  us ($4/$3):5 w lp t "rk6", \
+     file index 7  us ($4/$3):5 w lp t "gl2", \
+     file index 10 us ($4/$3):5 w lp t "gl4"
+set title "current sheet"
+plot file index 1  us ($4/$3):5 w lp t "rk4", \
+     file index 4  us ($4/$3):5 w lp t "rk6", \
+     file index 8  us ($4/$3):5 w lp t "gl2", \
+     file index 11 us ($4/$3):5 w lp t "gl4", \
+     file index 13 us ($4/$3):5 w lp t "RK4", \
+     file index 14 us ($4/$3):5 w lp t "RK6"
+set title "harmonic well"
+plot file index 2  us ($4/$3):5 w lp t "rk4", \
+     file index 5  us ($4/$3):5 w lp t "rk6", \
+     file index 6  us ($4/$3):5 w lp t "sv2", \
+     file index 9  us ($4/$3):5 w lp t "gl2", \
+     file index 12 us ($4/$3):5 w lp t "gl4"
+unset multiplot
+unset title
+unset logscale
+set format y
+
+# end
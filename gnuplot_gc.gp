@@ -0,0 +1,20 @@
+# This routine displays a particle orbit in the "data/gc.dat" file.
+# To use, run the program in the following way.
+#   $ ./sample_gc > data/gc.dat
+# Then, load this routine from the gnuplot.
+#   $ gnuplot
+#   gnuplot> load "gnuplot_gc.gp"
+#
+# Red points are full-orbit steps, blue points are guiding-center steps.
+
+unset key
+
+file="data/gc.dat"
+set xlabel "x"
+set ylabel "z"
+plot file us 2:($8==0?$4:1/0) w points pt 7 ps 0.3 lt 1, \
+     file us 2:($8==1?$4:1/0) w points pt 7 ps 0.3 lt 3
+
+set key
+
+# end
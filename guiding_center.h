@@ -0,0 +1,368 @@
+//  -*- C++ -*-
+//  guiding-center test particle                last updated : 2026/10/19
+
+//
+//  Copyright (C) 2026
+//             Seiji Zenitani <zenitani@gmail.com>
+//
+//  You may copy, use, modify and redistribute this code
+//  for ANY PURPOSE, without significant change, as long as
+//  all copyright notice are retained.
+//  The author provides this code `as is', and declares that
+//  there is no warranty for it.
+//
+//
+// *** History ***
+//
+// 2026/10/19  Ver 0.1   guiding-center mode with automatic switching
+//
+
+// *** Notice ***
+//
+//   particle.h is required (full-orbit motion and F()).
+//
+//   external field functions,
+//      vector3 E( const vector3& _r );
+//      vector3 B( const vector3& _r );
+//      should be defined in your program, in addition to F().
+//
+//   In the guiding-center (GC) mode, the particle is advanced by
+//   the non-relativistic drift equations
+//
+//     dR/dt   = vpar b + ( E x B )/B^2
+//               + mu/(qB) b x grad B + m vpar^2/(qB) b x (b.grad)b
+//     m dvpar/dt = q E.b - mu b.grad B
+//
+//   with the magnetic moment mu conserved.  grad B and the field-line
+//   curvature (b.grad)b are evaluated by central differences of B().
+//
+//   push() switches between the full-orbit and the GC modes by the
+//   adiabaticity parameter kappa = sqrt( Rc/rho ), where Rc is the
+//   smaller of the field-line curvature radius and B/|grad B|.
+//   While in the GC mode, r and v hold the guiding-center position
+//   and velocity ( dR/dt with all the drifts, of the last stage of a
+//   step ); R, vpar and mu are the GC variables.
+//
+//   grad B and the curvature cost 8 calls of B(), so a GC step costs
+//   40 field calls ( E() or B() ), counted as such by STATS_STEP.  In
+//   the GC mode push() takes kappa from the geometry of the first
+//   stage; in the full-orbit mode it evaluates kappa ( 10 calls )
+//   only every nk-th step.
+
+
+#ifndef _Z_GUIDING_CENTER_H_
+#define _Z_GUIDING_CENTER_H_
+
+#include <math.h>
+#include <vector3.h>
+#include <particle.h>
+#include <RK.h>
+
+
+//
+// field function E(), B() prototypes
+//
+
+vector3 E( const vector3& );
+vector3 B( const vector3& );
+
+
+//
+// guiding-center particle class
+//
+// push( h_fo, h_gc ) ==> one step of rk4() or gc4(), automatic switching
+// gc4()              ==> guiding-center motion (non-relativistic)
+// to_gc(), to_fo()   ==> manual conversion
+//
+
+class gcparticle : public particle
+{
+
+protected:
+  double mu, vpar, phase;
+  vector3 e1;
+  int gc, ik;
+
+  void gc_geometry( const vector3&, const vector3&, vector3&, vector3& ) const;
+  void gc_rhs( const vector3&, const double&, const vector3&, const vector3&,
+               const vector3&, vector3&, double& ) const;
+  double kappa( const vector3&, const vector3&, const vector3&,
+                const vector3& ) const;
+  void gc_step( const double&, const vector3&, const vector3&, const vector3& );
+  void to_gc( vector3&, vector3&, vector3& );
+
+public:
+  // guiding-center position
+  vector3 R;
+  // switching thresholds ( kappa > kon ==> GC, kappa < koff ==> orbit )
+  double kon, koff;
+  // finite-difference width for grad B and curvature
+  double dx;
+  // kappa every nk-th step in the full-orbit mode
+  int nk;
+
+  // constructor
+  gcparticle( void );
+
+  // get functions
+  double getmu( void ) const;
+  double getvpar( void ) const;
+  int    isgc( void ) const;
+
+  double kappa( void ) const;
+
+  // conversion
+  void to_gc( void );
+  void to_fo( void );
+
+  // guiding-center motion
+  void gc4( const double& );
+
+  // automatic switching, returns 1 in the GC mode
+  int  push( const double&, const double& );
+
+};
+
+
+// ---- constructor -----
+
+inline gcparticle::gcparticle( void )
+  : particle(), mu(0.0), vpar(0.0), phase(0.0), gc(0), ik(0),
+    kon(5.0), koff(3.0), dx(1.0e-4), nk(4)
+{
+  e1.set(); R.set();
+}
+
+// ---- member functions -----
+
+inline double gcparticle::getmu( void ) const{ return mu; }
+inline double gcparticle::getvpar( void ) const{ return vpar; }
+inline int    gcparticle::isgc( void ) const{ return gc; }
+
+// grad B and curvature (b.grad)b at _r, where the field is _B
+// ( 8 calls of B() )
+inline void gcparticle::gc_geometry( const vector3& _r, const vector3& _B,
+                                     vector3& gradB, vector3& curv ) const
+{
+  STATS_TIMER( STATS_FIELD );
+  vector3 ex( 1.0, 0.0, 0.0 ), ey( 0.0, 1.0, 0.0 ), ez( 0.0, 0.0, 1.0 );
+  double h2_inv = 0.5 / dx;
+  vector3 b0 = _B / _B.abs();
+
+  gradB.set( B(_r+dx*ex).abs() - B(_r-dx*ex).abs(),
+             B(_r+dx*ey).abs() - B(_r-dx*ey).abs(),
+             B(_r+dx*ez).abs() - B(_r-dx*ez).abs() );
+  gradB *= h2_inv;
+
+  vector3 bp = B(_r+dx*b0);
+  vector3 bm = B(_r-dx*b0);
+  curv = ( bp/bp.abs() - bm/bm.abs() ) * h2_inv;
+}
+
+// right-hand side of the drift equations, for the field _B and its
+// geometry at _R ( 1 call of E() )
+inline void gcparticle::gc_rhs( const vector3& _R, const double& _vpar,
+                                const vector3& _B, const vector3& gradB,
+                                const vector3& curv,
+                                vector3& dR, double& dvpar ) const
+{
+  vector3 _E = E(_R);
+  double  Bm = _B.abs();
+  vector3 b  = _B / Bm;
+
+  dR = _vpar * b + ( _E * _B ) / ( Bm*Bm )
+    + ( mu / (q*Bm) ) * ( b * gradB )
+    + ( m*_vpar*_vpar / (q*Bm) ) * ( b * curv );
+  dvpar = m_inv * ( q * ( _E % b ) - mu * ( b % gradB ) );
+}
+
+// adiabaticity parameter kappa = sqrt( Rc/rho ) from the geometry
+// at _r ( 1 call of E() in the full-orbit mode )
+inline double gcparticle::kappa( const vector3& _r, const vector3& _B,
+                                 const vector3& gradB,
+                                 const vector3& curv ) const
+{
+  if( q == 0.0 ) return 0.0;
+
+  double Bm = _B.abs();
+  double vperp;
+  if( gc ){
+    vperp = sqrt( 2.0 * mu * Bm * m_inv );
+  }else{
+    vector3 w = v - ( v % _B ) * _B / ( Bm*Bm ) - ( E(_r) * _B ) / ( Bm*Bm );
+    vperp = w.abs();
+  }
+  if( vperp == 0.0 ) return HUGE_VAL;
+
+  double Lk = curv.abs();
+  double Lg = gradB.abs() / Bm;
+  double Linv = ( Lk > Lg ? Lk : Lg );
+  if( Linv == 0.0 ) return HUGE_VAL;
+
+  double rho = m * vperp / ( fabs(q) * Bm );
+  return sqrt( 1.0 / ( Linv * rho ) );
+}
+
+inline double gcparticle::kappa( void ) const
+{
+  vector3 _r = ( gc ? R : r );
+  vector3 _B = B(_r);
+  vector3 gradB, curv;
+  gc_geometry( _r, _B, gradB, curv );
+  return kappa( _r, _B, gradB, curv );
+}
+
+// full orbit ==> guiding center, also returns the field and its
+// geometry at R ( 12 field calls )
+inline void gcparticle::to_gc( vector3& _BR, vector3& gradB, vector3& curv )
+{
+  vector3 _B = B(r);
+  double  B2 = _B.abs2();
+  double  Bm = sqrt( B2 );
+  vector3 b  = _B / Bm;
+  vector3 vE = ( E(r) * _B ) / B2;
+
+  vpar = v % b;
+  vector3 w = v - vpar * b - vE;
+  mu = 0.5 * m * w.abs2() / Bm;
+  R  = r + ( m / q ) * ( w * _B ) / B2;
+
+  // the gyrophase is measured from the current gyration velocity
+  double wm = w.abs();
+  if( wm > 0.0 ) e1 = w / wm;
+  else           e1 = ( fabs(b.x) < 0.9 ? vector3(1,0,0) : vector3(0,1,0) );
+  phase = 0.0;
+
+  double dvpar;
+  _BR = B(R);
+  gc_geometry( R, _BR, gradB, curv );
+  gc_rhs( R, vpar, _BR, gradB, curv, v, dvpar );
+  r  = R;
+  gc = 1;
+  STATS_FORCE( 12 );
+  STATS_SWITCH();
+}
+
+inline void gcparticle::to_gc( void )
+{
+  vector3 _B, gradB, curv;
+  to_gc( _B, gradB, curv );
+}
+
+// guiding center ==> full orbit
+inline void gcparticle::to_fo( void )
+{
+  vector3 _B = B(R);
+  double  B2 = _B.abs2();
+  double  Bm = sqrt( B2 );
+  vector3 b  = _B / Bm;
+  vector3 vE = ( E(R) * _B ) / B2;
+
+  // re-orthogonalize the phase reference against the local field
+  vector3 u1 = e1 - ( e1 % b ) * b;
+  if( u1.abs2() < 1.0e-12 ){
+    u1 = ( fabs(b.x) < 0.9 ? vector3(1,0,0) : vector3(0,1,0) );
+    u1 -= ( u1 % b ) * b;
+  }
+  u1 /= u1.abs();
+  vector3 u2 = b * u1;
+
+  vector3 w = sqrt( 2.0 * mu * Bm * m_inv )
+    * ( cos(phase) * u1 - sin(phase) * u2 );
+
+  v  = vpar * b + vE + w;
+  r  = R - ( m / q ) * ( w * _B ) / B2;
+  gc = 0;
+  STATS_FORCE( 2 );
+  STATS_SWITCH();
+}
+
+// proceed the guiding center by the 4th order Runge-Kutta method,
+// given the field and its geometry at R ( 31 field calls )
+inline void gcparticle::gc_step( const double& h, const vector3& _B0,
+                                 const vector3& gradB0, const vector3& curv0 )
+{
+  int i,j;
+  vector3 kR[4];
+  double  kp[4];
+  vector3 tmpR, _B, gradB, curv;
+  double  tmpp;
+
+  // gyrophase, for reconstructing the orbit later
+  phase += q * _B0.abs() * m_inv * h;
+
+  // k1
+  gc_rhs( R, vpar, _B0, gradB0, curv0, kR[0], kp[0] );
+
+  // k2 ... k4
+  for( i=0; i<3; i++ ){
+    tmpR = st44[i][0] * kR[0];
+    tmpp = st44[i][0] * kp[0];
+    for( j=1; j<(i+1); j++ ){
+      tmpR += st44[i][j] * kR[j];
+      tmpp += st44[i][j] * kp[j];
+    }
+    tmpR = R + tmpR*h;
+    _B = B(tmpR);
+    gc_geometry( tmpR, _B, gradB, curv );
+    gc_rhs( tmpR, vpar+tmpp*h, _B, gradB, curv, kR[i+1], kp[i+1] );
+  }
+
+  tmpR = st44[3][0] * kR[0];
+  tmpp = st44[3][0] * kp[0];
+  for( j=1; j<4; j++ ){
+    tmpR += st44[3][j] * kR[j];
+    tmpp += st44[3][j] * kp[j];
+  }
+
+  STATS_STEP( 40, h );
+  t    += h;
+  R    += tmpR*h;
+  vpar += tmpp*h;
+
+  r = R;
+  v = kR[3];
+}
+
+// ( 40 field calls )
+inline void gcparticle::gc4( const double& h )
+{
+  vector3 _B = B(R);
+  vector3 gradB, curv;
+  gc_geometry( R, _B, gradB, curv );
+  gc_step( h, _B, gradB, curv );
+}
+
+// one step with automatic switching
+//   h_fo : timestep in the full-orbit mode (rk4)
+//   h_gc : timestep in the guiding-center mode (gc4)
+inline int gcparticle::push( const double& h_fo, const double& h_gc )
+{
+  vector3 _B, gradB, curv;
+
+  if( gc ){
+    // the geometry of the first stage also gives kappa
+    _B = B(R);
+    gc_geometry( R, _B, gradB, curv );
+    if( kappa( R, _B, gradB, curv ) < koff ){
+      // the GC step is given up for the full orbit
+      STATS_FORCE( 9 );
+      to_fo();
+      ik = 0;
+    }
+  }else if( ++ik >= nk ){
+    ik = 0;
+    _B = B(r);
+    gc_geometry( r, _B, gradB, curv );
+    STATS_FORCE( 10 );
+    if( kappa( r, _B, gradB, curv ) > kon ) to_gc( _B, gradB, curv );
+  }
+
+  if( gc ) gc_step( h_gc, _B, gradB, curv );
+  else     rk4( h_fo );
+  return gc;
+}
+
+# endif
+
+// end
@@ -0,0 +1,31 @@
+// A second translation unit for "make odr".
+// Linking it with a sample fails if any header function is not inline.
+
+#include <vector3.h>
+#include <RK.h>
+#include <particle.h>
+#include <guiding_center.h>
+#include <ensemble.h>
+#include <sorting.h>
+#include <sampler.h>
+#include <driver.h>
+#include <trajfile.h>
+#include <fields.h>
+#include <fieldtable.h>
+#include <plugin.h>
+#include <ppp.h>
+#include <attractor.h>
+#include <trajectory.h>
+#include <stats.h>
+
+double odr_check( void )
+{
+  vector3 a( 1.0, 2.0, 3.0 );
+  a.set();
+  particle p;
+  p.reset();
+  vector3 b = ( field_harris( 1.0, 1.0 ) + field_uniform( a, a ) ).B( a );
+  return abs( cross( a, a ) ) + dot( a, b );
+}
+
+// end
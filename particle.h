@@ -1,5 +1,5 @@
 //  -*- C++ -*-
-//  electromagnetic test particle code         last updated : 2018/07/28
+//  electromagnetic test particle code         last updated : 2026/10/19
 
 //
 //  Copyright (C) 1998-2001, 2018
@@ -18,6 +18,10 @@
 // 1999/03/10  Ver 1.0   stable release
 // 2000/09/28      1.1   ready for relativistic motion
 // 2001/09/27  Ver 1.5   integrated with relativistic version
+// 2026/10/19      1.6   symplectic (Stormer-Verlet, Gauss-Legendre) methods,
+//                       all functions inline and reentrant,
+//                       fused stage sums, const reference getters,
+//                       cached Lorentz factor in RK4(), RK6()
 // 
 
 // *** Notice ***
@@ -37,6 +41,7 @@
 #include <math.h>
 #include <vector3.h>
 #include <RK.h>
+#include <stats.h>
 
 
 //
@@ -52,6 +57,13 @@ vector3 F( const vector3&, const vector3&,
 //
 // rk4(), rk6() ==> non-relativistic motion
 // RK4(), RK6() ==> relativistic motion  ( c = 1.0 )
+//                  v is the 4-velocity u = gamma*v;
+//                  getgamma() and getvel() give gamma and u/gamma
+//
+// sv2()        ==> Stormer-Verlet, for forces independent of v
+// gl2(), gl4() ==> implicit Gauss-Legendre, non-relativistic motion
+//                  ( symplectic, quadratic invariants such as |v|^2
+//                    in a static magnetic field are preserved )
 //
 
 class particle
@@ -68,15 +80,18 @@ public:
   // constructor
   particle( void );
   
-  // operator
-  particle& operator  = ( const particle& );
+  // copy and assignment are implicit
 
   // get functions
   double  getm( void ) const;
   double  getq( void ) const;
   double  gett( void ) const;
-  vector3 getr( void ) const;
-  vector3 getv( void ) const;
+  const vector3& getr( void ) const;
+  const vector3& getv( void ) const;
+
+  // relativistic
+  double  getgamma( void ) const;
+  vector3 getvel( void ) const;
 
   // set functions
   void setm( const double& );
@@ -98,6 +113,11 @@ public:
   void rk4( const double& );
   void rk6( const double& );
 
+  // symplectic
+  void sv2( const double& );
+  void gl2( const double& );
+  void gl4( const double& );
+
   // relativistic
   void RK4( const double& );
   void RK6( const double& );
@@ -107,28 +127,25 @@ public:
 
 // ---- constructor -----
 
-particle::particle( void )
+inline particle::particle( void )
   : m(1.0), m_inv(1.0), q(0.0), t(0.0)
 {
   r.set(); v.set();
 }
 
-// ---- operators ----
-inline particle& particle::operator = ( const particle& p )
-{
-  m = p.m ; m_inv = p.m_inv;
-  q = p.q ; t = p.t ;
-  r = p.r ; v = p.v ;
-  return *this;
-}
-
 // ---- member functions -----
 
 inline double  particle::getm( void ) const{ return m; }
 inline double  particle::getq( void ) const{ return q; }
 inline double  particle::gett( void ) const{ return t; }
-inline vector3 particle::getr( void ) const{ return r; }
-inline vector3 particle::getv( void ) const{ return v; }
+inline const vector3& particle::getr( void ) const{ return r; }
+inline const vector3& particle::getv( void ) const{ return v; }
+
+inline double particle::getgamma( void ) const{ return v.ugamma(); }
+inline vector3 particle::getvel( void ) const
+{
+  return ( 1.0 / getgamma() ) * v;
+}
 
 inline void particle::setm( const double& _m ){
   m = _m;  m_inv = 1.0 / _m;
@@ -165,9 +182,9 @@ inline void particle::reset( void ){ v.set(); r.set(); t=0.0; }
 // proceed by Runge-Kutta methods
 inline void particle::rk4( const double& h )
 {
-  register int i,j;
-  static vector3 kr[4],kv[4];
-  static vector3 tmpr, tmpv;
+  int i;
+  vector3 kr[4],kv[4];
+  vector3 rs;
 
   // k1
   kr[0] = v;
@@ -175,26 +192,15 @@ inline void particle::rk4( const double& h )
 
   // k2 ... k4
   for( i=0; i<3; i++ ){
-    tmpr = st44[i][0] * kr[0];
-    tmpv = st44[i][0] * kv[0];
-    for( j=1; j<(i+1); j++ ){
-      tmpr += st44[i][j] * kr[j];
-      tmpv += st44[i][j] * kv[j];
-    }
-    kr[i+1] = v + tmpv*h;
-    kv[i+1] = m_inv * F( r+tmpr*h,v+tmpv*h,t+st44[i][3]*h, q );
+    rs.set( r, h, st44[i], kr, i+1 );
+    kr[i+1].set( v, h, st44[i], kv, i+1 );
+    kv[i+1] = m_inv * F( rs,kr[i+1],t+st44[i][3]*h, q );
   }
 
-  tmpr = st44[3][0] * kr[0];
-  tmpv = st44[3][0] * kv[0];
-  for( j=1; j<4; j++ ){
-    tmpr += st44[3][j] * kr[j];
-    tmpv += st44[3][j] * kv[j];
-  }
-  
+  STATS_STEP( 4, h );
   t += h;
-  r += tmpr*h;
-  v += tmpv*h;
+  r.madd( h, st44[3], kr, 4 );
+  v.madd( h, st44[3], kv, 4 );
   return;
 
 }
@@ -202,9 +208,9 @@ inline void particle::rk4( const double& h )
 // 6th order
 inline void particle::rk6( const double& h )
 {
-  register int i,j;
-  static vector3 kr[7],kv[7];
-  static vector3 tmpr, tmpv;
+  int i;
+  vector3 kr[7],kv[7];
+  vector3 rs;
 
   // k1
   kr[0] = v;
@@ -212,100 +218,155 @@ inline void particle::rk6( const double& h )
 
   // k2 ... k7
   for( i=0; i<6; i++ ){
-    tmpr = st76[i][0] * kr[0];
-    tmpv = st76[i][0] * kv[0];
-    for( j=1; j<(i+1); j++ ){
-      tmpr += st76[i][j] * kr[j];
-      tmpv += st76[i][j] * kv[j];
-    }
-    kr[i+1] = v + tmpv*h;
-    kv[i+1] = m_inv * F( r+tmpr*h,v+tmpv*h,t+st76[i][6]*h, q );
+    rs.set( r, h, st76[i], kr, i+1 );
+    kr[i+1].set( v, h, st76[i], kv, i+1 );
+    kv[i+1] = m_inv * F( rs,kr[i+1],t+st76[i][6]*h, q );
   }
-  
-  tmpr = st76[6][0] * kr[0];
-  tmpv = st76[6][0] * kv[0];
-  for( j=1; j<7; j++ ){
-    tmpr += st76[6][j] * kr[j];
-    tmpv += st76[6][j] * kv[j];
+
+  STATS_STEP( 7, h );
+  t += h;
+  r.madd( h, st76[6], kr, 7 );
+  v.madd( h, st76[6], kv, 7 );
+  return;
+
+}
+
+// Stormer-Verlet (kick-drift-kick)
+//   symplectic only if F() does not depend on v
+inline void particle::sv2( const double& h )
+{
+  v += ( 0.5*h*m_inv ) * F( r,v,t, q );
+  r.madd( h, v );
+  t += h;
+  v += ( 0.5*h*m_inv ) * F( r,v,t, q );
+  STATS_STEP( 2, h );
+  return;
+}
+
+// implicit midpoint rule
+inline void particle::gl2( const double& h )
+{
+  int it;
+  vector3 kr, kv, nr, nv;
+  double err, norm, errp = 0.0;
+
+  // initial guess
+  kr = v;
+  kv = m_inv * F( r,v,t, q );
+
+  for( it=0; it<gl_itmax; it++ ){
+    nr = v + gl22[0][0]*kv*h;
+    nv = m_inv * F( r+gl22[0][0]*kr*h,nr,t+gl22[0][1]*h, q );
+    err  = ( nr-kr ).abs2() + ( nv-kv ).abs2();
+    norm = nr.abs2() + nv.abs2();
+    kr = nr;  kv = nv;
+    if( err <= gl_eps*gl_eps*norm ) break;
+    // stalled or diverging
+    if( it > 0 && err >= errp ){ STATS_NOCONV();  break; }
+    errp = err;
+  }
+  if( it == gl_itmax ) STATS_NOCONV();
+
+  STATS_STEP( 1 + ( it<gl_itmax ? it+1 : it ), h );
+  t += h;
+  r.madd( h, kr );
+  v.madd( h, kv );
+  return;
+
+}
+
+// 4th order Gauss-Legendre
+inline void particle::gl4( const double& h )
+{
+  int i,it;
+  vector3 kr[2],kv[2];
+  vector3 tmpr, tmpv, nr, nv;
+  double err, norm, errp = 0.0;
+
+  // initial guess
+  kr[0] = v;
+  kv[0] = m_inv * F( r,v,t, q );
+  kr[1] = kr[0];  kv[1] = kv[0];
+
+  for( it=0; it<gl_itmax; it++ ){
+    err = 0.0;
+    norm = 0.0;
+    for( i=0; i<2; i++ ){
+      tmpr = gl33[i][0] * kr[0] + gl33[i][1] * kr[1];
+      tmpv = gl33[i][0] * kv[0] + gl33[i][1] * kv[1];
+      nr = v + tmpv*h;
+      nv = m_inv * F( r+tmpr*h,nr,t+gl33[i][2]*h, q );
+      err  += ( nr-kr[i] ).abs2() + ( nv-kv[i] ).abs2();
+      norm += nr.abs2() + nv.abs2();
+      kr[i] = nr;  kv[i] = nv;
+    }
+    if( err <= gl_eps*gl_eps*norm ) break;
+    // stalled or diverging
+    if( it > 0 && err >= errp ){ STATS_NOCONV();  break; }
+    errp = err;
   }
+  if( it == gl_itmax ) STATS_NOCONV();
 
+  STATS_STEP( 1 + 2*( it<gl_itmax ? it+1 : it ), h );
   t += h;
-  r += tmpr*h;
-  v += tmpv*h;
+  r += ( gl33[2][0] * kr[0] + gl33[2][1] * kr[1] ) * h;
+  v += ( gl33[2][0] * kv[0] + gl33[2][1] * kv[1] ) * h;
   return;
 
 }
 
 // relativistic motion
 // proceed by Runge-Kutta methods
-void particle::RK4( const double& h )
+inline void particle::RK4( const double& h )
 {
-  register int i,j;
-  static vector3 kr[4],kv[4];
-  static vector3 tmpr, tmpv;
+  int i;
+  vector3 kr[4],kv[4];
+  vector3 rs, us;
 
   // k1
-  kr[0] = v.uv2v();
-  kv[0] = m_inv * F( r,v.uv2v(),t, q );
+  kr[0] = getvel();
+  kv[0] = m_inv * F( r,kr[0],t, q );
 
   // k2 ... k4
   for( i=0; i<3; i++ ){
-    tmpr = st44[i][0] * kr[0];
-    tmpv = st44[i][0] * kv[0];
-    for( j=1; j<(i+1); j++ ){
-      tmpr += st44[i][j] * kr[j];
-      tmpv += st44[i][j] * kv[j];
-    }
-    kr[i+1] = ( v+tmpv*h ).uv2v();
-    kv[i+1] = m_inv * F( r+tmpr*h,(v+tmpv*h).uv2v(),t+st44[i][3]*h, q );
+    // stage velocity, one square root per stage
+    rs.set( r, h, st44[i], kr, i+1 );
+    us.set( v, h, st44[i], kv, i+1 );
+    kr[i+1] = ( 1.0 / us.ugamma() ) * us;
+    kv[i+1] = m_inv * F( rs,kr[i+1],t+st44[i][3]*h, q );
   }
 
-  tmpr = st44[3][0] * kr[0];
-  tmpv = st44[3][0] * kv[0];
-  for( j=1; j<4; j++ ){
-    tmpr += st44[3][j] * kr[j];
-    tmpv += st44[3][j] * kv[j];
-  }
-  
+  STATS_STEP( 4, h );
   t += h;
-  r += tmpr*h;
-  v += tmpv*h;
+  r.madd( h, st44[3], kr, 4 );
+  v.madd( h, st44[3], kv, 4 );
   return;
 
 }
 
-void particle::RK6( const double& h )
+inline void particle::RK6( const double& h )
 {
-  register int i,j;
-  static vector3 kr[7],kv[7];
-  static vector3 tmpr, tmpv;
+  int i;
+  vector3 kr[7],kv[7];
+  vector3 rs, us;
 
   // k1
-  kr[0] = v.uv2v();
-  kv[0] = m_inv * F( r,v.uv2v(),t, q );
+  kr[0] = getvel();
+  kv[0] = m_inv * F( r,kr[0],t, q );
 
   // k2 ... k7
   for( i=0; i<6; i++ ){
-    tmpr = st76[i][0] * kr[0];
-    tmpv = st76[i][0] * kv[0];
-    for( j=1; j<(i+1); j++ ){
-      tmpr += st76[i][j] * kr[j];
-      tmpv += st76[i][j] * kv[j];
-    }
-    kr[i+1] = ( v+tmpv*h ).uv2v();
-    kv[i+1] = m_inv * F( r+tmpr*h,(v+tmpv*h).uv2v(),t+st76[i][6]*h, q );
-  }
-  
-  tmpr = st76[6][0] * kr[0];
-  tmpv = st76[6][0] * kv[0];
-  for( j=1; j<7; j++ ){
-    tmpr += st76[6][j] * kr[j];
-    tmpv += st76[6][j] * kv[j];
+    // stage velocity, one square root per stage
+    rs.set( r, h, st76[i], kr, i+1 );
+    us.set( v, h, st76[i], kv, i+1 );
+    kr[i+1] = ( 1.0 / us.ugamma() ) * us;
+    kv[i+1] = m_inv * F( rs,kr[i+1],t+st76[i][6]*h, q );
   }
 
+  STATS_STEP( 7, h );
   t += h;
-  r += tmpr*h;
-  v += tmpv*h;
+  r.madd( h, st76[6], kr, 7 );
+  v.madd( h, st76[6], kv, 7 );
   return;
 
 }
@@ -0,0 +1,157 @@
+//  -*- C++ -*-
+//  force models as shared libraries            last updated : 2026/10/19
+
+//
+//  Copyright (C) 2026
+//             Seiji Zenitani <zenitani@gmail.com>
+//
+//  You may copy, use, modify and redistribute this code
+//  for ANY PURPOSE, without significant change, as long as
+//  all copyright notice are retained.
+//  The author provides this code `as is', and declares that
+//  there is no warranty for it.
+//
+//
+// *** History ***
+//
+// 2026/10/19  Ver 0.1   batched force kernel ABI, dlopen loader
+//
+
+// *** Notice ***
+//
+//   ensemble.h is required, and dlopen() ( -ldl on older systems ).
+//
+//   A force model is built alone as a plugin, which exports F() as
+//   a batched kernel ( ppp_force_kernel of ensemble.h ) through one
+//   C function:
+//
+//     // plugin_mine.cpp
+//     #include <plugin.h>
+//     vector3 F( const vector3& _r, const vector3& _v,
+//                const double& _t, const double& _q ){ ... }
+//     PPP_PLUGIN( "mine" )
+//
+//     g++ -O2 -std=c++20 -I. -shared -fPIC -fvisibility=hidden
+//         plugin_mine.cpp -o plugin_mine.so      ( 'make plugin' )
+//
+//   A prebuilt program loads it at run time:
+//
+//     plugin pl;
+//     if( pl.open( "./plugin_mine.so" ) < 0 ) ...  // -1 on failure
+//     e.force = pl.force();       // ensemble::RK4(), RK6() use it
+//
+//   The plugin loops over F() in its own translation unit, so F()
+//   inlines into the kernel; with -fvisibility=hidden only the entry
+//   point is exported.  The ABI version is checked by open().
+
+
+#ifndef _Z_PLUGIN_H_
+#define _Z_PLUGIN_H_
+
+#include <stdio.h>
+#include <dlfcn.h>
+#include <vector3.h>
+#include <ensemble.h>
+
+
+// ABI version, raised on any change of ppp_plugin_info or the kernel
+const int ppp_plugin_abi = 1;
+
+extern "C" {
+  struct ppp_plugin_info
+  {
+    int abi;
+    const char* name;
+    ppp_force_kernel force;
+  };
+  // entry point of a plugin, named "ppp_plugin"
+  typedef const ppp_plugin_info* (*ppp_plugin_entry)( void );
+}
+
+// defines the kernel and the entry point from F() of this file
+#define PPP_PLUGIN( NAME )                                                  \
+  static void ppp_plugin_force( int n, const double* x, const double* y,   \
+                                const double* z, const double* vx,          \
+                                const double* vy, const double* vz,         \
+                                const double* t, double q,                  \
+                                double* fx, double* fy, double* fz )        \
+  {                                                                         \
+    for( int k=0; k<n; k++ ){                                               \
+      vector3 f = F( vector3( x[k], y[k], z[k] ),                           \
+                     vector3( vx[k], vy[k], vz[k] ), t[k], q );             \
+      fx[k] = f.x;  fy[k] = f.y;  fz[k] = f.z;                              \
+    }                                                                       \
+  }                                                                         \
+  extern "C" __attribute__(( visibility( "default" ) ))                     \
+  const ppp_plugin_info* ppp_plugin( void )                                 \
+  {                                                                         \
+    static const ppp_plugin_info info = { ppp_plugin_abi, NAME,             \
+                                          ppp_plugin_force };               \
+    return &info;                                                           \
+  }
+
+
+//
+// plugin class ( loader )
+//
+
+class plugin
+{
+
+protected:
+  void* handle;
+  const ppp_plugin_info* info;
+
+  // not copyable
+  plugin( const plugin& );
+  plugin& operator = ( const plugin& );
+
+public:
+  // constructor
+  plugin( void ) : handle(0), info(0) {}
+  ~plugin( void ){ close(); }
+
+  int  open( const char* );
+  void close( void );
+
+  const char* name( void ) const;
+  ppp_force_kernel force( void ) const;
+
+};
+
+
+// ---- member functions -----
+
+// returns 0, or -1 with a message on stderr
+inline int plugin::open( const char* path )
+{
+  close();
+  handle = dlopen( path, RTLD_NOW | RTLD_LOCAL );
+  if( !handle ){
+    fprintf( stderr, "plugin: %s\n", dlerror() );
+    return -1;
+  }
+  ppp_plugin_entry entry = (ppp_plugin_entry) dlsym( handle, "ppp_plugin" );
+  if( entry ) info = entry();
+  if( !info || info->abi != ppp_plugin_abi || !info->force ){
+    fprintf( stderr, "plugin: %s is not a p++ plugin of ABI %d\n",
+             path, ppp_plugin_abi );
+    close();
+    return -1;
+  }
+  return 0;
+}
+
+inline void plugin::close( void )
+{
+  if( handle ) dlclose( handle );
+  handle = 0;
+  info = 0;
+}
+
+inline const char* plugin::name( void ) const{ return ( info ? info->name : 0 ); }
+inline ppp_force_kernel plugin::force( void ) const{ return ( info ? info->force : 0 ); }
+
+# endif
+
+// end
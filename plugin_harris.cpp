@@ -0,0 +1,26 @@
+#include <plugin.h>
+#include <fields.h>
+
+/* *********************************************************************
+ Force model plugin: the current sheet of sample_gc.cpp with a
+ dipole below it, as a shared library for sample_sweep.cpp.
+
+   make plugin        ( plugin_harris.so )
+ ********************************************************************* */
+
+// ************* initial parameters ************************************
+// normal magnetic field
+const double bn = 0.2;
+// ************* initial parameters ************************************
+
+// field model ( fields.h )
+const auto fld = field_harris( 1.0, 1.0, 0.0, bn )
+  + field_dipole( vector3(0.0,0.0,-10.0), vector3(0.0,0.0,-10.0), 1.0 );
+
+// force
+vector3 F( const vector3& _r, const vector3& _v,
+           const  double& _t, const  double& _q ){
+  return fld.force( _r, _v, _t, _q );
+}
+
+PPP_PLUGIN( "harris + dipole" )
@@ -0,0 +1,48 @@
+//  -*- C++ -*-
+//  precompiled core headers                    last updated : 2026/10/19
+
+//
+//  Copyright (C) 2026
+//             Seiji Zenitani <zenitani@gmail.com>
+//
+//  You may copy, use, modify and redistribute this code
+//  for ANY PURPOSE, without significant change, as long as
+//  all copyright notice are retained.
+//  The author provides this code `as is', and declares that
+//  there is no warranty for it.
+//
+//
+// *** History ***
+//
+// 2026/10/19  Ver 0.1   umbrella header for 'make pch'
+//
+
+// *** Notice ***
+//
+//   The core headers in one, to be precompiled ( 'make pch' ) and
+//   given first by -include ppp.h:
+//
+//     make pch
+//     g++ -O2 -std=c++20 -I. -include ppp.h my_sample.cpp
+//
+//   as 'make open_pch' builds sample_open.
+//
+//   The compiler then loads ppp.h.gch ( ppp.h.pch for clang++ )
+//   instead of parsing the headers, if the flags are the same as in
+//   the Makefile.  The headers only declare F(), so one precompiled
+//   header serves every force model.
+
+
+#ifndef _Z_PPP_H_
+#define _Z_PPP_H_
+
+#include <vector3.h>
+#include <RK.h>
+#include <stats.h>
+#include <particle.h>
+#include <ensemble.h>
+#include <fields.h>
+
+# endif
+
+// end
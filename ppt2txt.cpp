@@ -0,0 +1,38 @@
+#include <trajfile.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* *********************************************************************
+ Prints a compressed trajectory file ( trajfile.h ) as text.
+
+   $ ./ppt2txt data/rossler.ppt                 all records
+   $ ./ppt2txt data/rossler.ppt 0               particle 0
+   $ ./ppt2txt data/rossler.ppt 0 100 200       particle 0, 100 <= t <= 200
+
+ Each line is "id rec[0] rec[1] ...", rec[0] = t, in full precision.
+ ********************************************************************* */
+
+int main( int argc, char** argv )
+{
+  trajreader rd;
+  if( argc < 2 || rd.open( argv[1] ) < 0 ){
+    fprintf( stderr, "usage: ppt2txt file [ id [ t0 t1 ] ]\n" );
+    return -1;
+  }
+  long   id = ( argc > 2 ? atol( argv[2] ) : -1 );
+  double t0 = ( argc > 4 ? atof( argv[3] ) : -HUGE_VAL );
+  double t1 = ( argc > 4 ? atof( argv[4] ) :  HUGE_VAL );
+  rd.seek( id, t0, t1 );
+
+  int nvar = rd.getnvar();
+  double* rec = new double[nvar];
+  int ok;
+  while( ( ok = rd.next( id, rec ) ) > 0 ){
+    printf( "%ld", id );
+    for( int k=0; k<nvar; k++ ) printf( " %.17g", rec[k] );
+    printf( "\n" );
+  }
+  delete [] rec;
+
+  return ( ok < 0 ? -1 : 0 );
+}
@@ -1,4 +1,4 @@
-#include <particle.h>
+#include <trajectory.h>
 #include <stdio.h>
 
 vector3 E( const vector3& _r ){
@@ -23,13 +23,25 @@ int main()
   p.setr(0.0,0.0,0.0);
   p.setv(0.3,0.0,0.1);
 
-  // rewinding
+  // rewinding, keeping every state ( a stride > 1 would recompute
+  // the states between checkpoints, as costly as rewinding again )
+  trajectory tr( 64, 1 );
   for( int i=0;p.gett()>-10; i++ ){
 //     printf( "%f %f %f %f %f %f\n",
 //          p.r.x, p.r.y, p.r.z,
 //          p.v.x, p.v.y, p.v.z );
+    tr.record( p );
     p.rk6(-0.2); // nonrelativistic motion
   }
+  // replaying the rewound segment
+  printf( "%f %f %f %f %f %f\n",
+          p.r.x, p.r.y, p.r.z, p.v.x, p.v.y, p.v.z );
+  for( long j=tr.last(); j>tr.first(); j-- ){
+    tr.get( j, p );
+    printf( "%f %f %f %f %f %f\n",
+            p.r.x, p.r.y, p.r.z, p.v.x, p.v.y, p.v.z );
+  }
+  tr.get( tr.first(), p );
   // marching in time
   for( int i=0;p.gett()<50; i++ ){
     printf( "%f %f %f %f %f %f\n",
@@ -0,0 +1,70 @@
+#include <attractor.h>
+#include <stdio.h>
+#include <math.h>
+
+/* *********************************************************************
+ Invariant measure and return map of the Lorenz attractor,
+ sampled by many trajectories at once.
+
+ index 0 : invariant measure in the (x,z) plane
+ index 1 : return map x_n -> x_n+1 at the section z = r-1
+ index 2 : distribution of the return time to the section
+ ********************************************************************* */
+
+// ************* Lorenz attractor ************************************
+// E. N. Lorenz, J. Atmos. Sci., 20, 130-141 (1963).
+const double sigma = 10.0;
+const double b = 8.0/3.0;
+const double r = 28.0;
+// ************* Lorenz attractor ************************************
+
+// ************* initial parameters ************************************
+// initial conditions on an ngrid x ngrid grid
+const int  ngrid = 141;
+const long nic   = long(ngrid) * ngrid;
+// ************* initial parameters ************************************
+
+struct lorenz
+{
+  static const int dim = 3;
+  void operator()( const double* y, double* dy ) const {
+    dy[0] = sigma*( -y[0] + y[1] );
+    dy[1] = - y[0]*y[2] + r*y[0] - y[1];
+    dy[2] = + y[0]*y[1] - b*y[2];
+  }
+};
+
+// initial conditions on a grid in -20 < x,y < 20, z = 20
+struct grid
+{
+  void operator()( const long& ic, double* y ) const {
+    y[0] = -20.0 + 40.0 * ( ic % ngrid ) / ngrid;
+    y[1] = -20.0 + 40.0 * ( ic / ngrid ) / ngrid;
+    y[2] = 20.0;
+  }
+};
+
+int main()
+{
+  attractor<lorenz> a( (lorenz()) );
+  a.h = 0.01;  a.nstep = 3000;  a.ntrans = 1000;
+  a.ia = 0;  a.alo = -25.0;  a.ahi = 25.0;  a.na = 200;
+  a.ib = 2;  a.blo =   0.0;  a.bhi = 50.0;  a.nb = 200;
+  a.is = 2;  a.sec = r-1;
+  a.iw = 0;  a.wlo = -20.0;  a.whi = 20.0;  a.nw = 200;
+  a.rmax = 2.0;  a.nr = 200;
+
+  grid init;
+  a.run( nic, init );
+
+  a.measure.write( stdout );
+  printf( "\n\n" );
+  a.retmap.write( stdout );
+  printf( "\n\n" );
+  a.rtime.write( stdout );
+
+  fprintf( stderr, "# %ld trajectories, %ld points, %ld section crossings\n",
+           nic, a.measure.nin, a.retmap.nin );
+
+  return 0;
+}
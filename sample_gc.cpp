@@ -0,0 +1,56 @@
+#include <guiding_center.h>
+#include <fields.h>
+#include <stdio.h>
+
+/* *********************************************************************
+ Guiding-center / full-orbit switching in a current sheet.
+
+ A particle starts in the lobe (strong, weakly curved field) and
+ bounces along the field line toward the sheet center, where the
+ field-line curvature becomes comparable to the Larmor radius.
+ gcparticle::push() follows the drift motion with a large timestep
+ in the lobe and resolves the full gyration only near the sheet.
+ ********************************************************************* */
+
+// ************* initial parameters ************************************
+// normal magnetic field
+const double bn = 0.2;
+// timesteps ( full orbit / guiding center )
+const double dt_fo = 0.01;
+const double dt_gc = 0.1;
+// ************* initial parameters ************************************
+
+// field model ( fields.h )
+const harris_field fld = field_harris( 1.0, 1.0, 0.0, bn );
+
+vector3 E( const vector3& _r ){ return fld.E( _r ); }
+vector3 B( const vector3& _r ){ return fld.B( _r ); }
+// force
+vector3 F( const vector3& _r, const vector3& _v,
+           const  double& _t, const  double& _q ){
+  return fld.force( _r, _v, _t, _q );
+}
+
+int main()
+{
+  gcparticle p;
+  p.sett(0);
+  p.setm(1);
+  p.setq(10);
+  p.setr(0.0,0.0,3.0);
+  p.setv(-0.2,0.0,0.1);
+
+  int nfo=0, ngc=0;
+  // marching in time
+  for( int i=0;p.gett()<200; i++ ){
+    printf( "%f %f %f %f %f %f %f %d\n",
+            p.gett(), p.r.x, p.r.y, p.r.z, p.v.x, p.v.y, p.v.z, p.isgc() );
+    if( p.push( dt_fo, dt_gc ) ) ngc++;
+    else nfo++;
+  }
+  fprintf( stderr, "# full-orbit steps: %d, guiding-center steps: %d\n",
+           nfo, ngc );
+  fprintf( stderr, "# full-orbit only: %d steps\n", int(200/dt_fo) );
+
+  return 0;
+}
@@ -1,4 +1,4 @@
-#include <particle.h>
+#include <trajfile.h>
 #include <stdio.h>
 
 // ************* Lorenz attractor ************************************
@@ -27,10 +27,16 @@ int main()
           - p.r.x*p.r.z + r*p.r.x - p.r.y,
           + p.r.x*p.r.z - b*p.r.z );
 
+  // full-precision copy of the orbit, see ppt2txt.cpp
+  trajwriter tw;
+  if( tw.open( "data/lorenz.ppt", 7 ) < 0 )
+    fprintf( stderr, "# cannot open data/lorenz.ppt, not written\n" );
+
   // marching in time
   for( int i=0;p.gett()<=60.0; i++ ){
     printf( "%f %f %f %f %f %f\n",
             p.r.x, p.r.y, p.r.z, p.v.x, p.v.y, p.v.z );
+    tw.write( 0, p );
     p.rk6(0.01); // nonrelativistic motion
   }
 
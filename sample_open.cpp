@@ -0,0 +1,64 @@
+#include <sorting.h>
+#include <sampler.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+/* *********************************************************************
+ Open-boundary run in the ExB field of sample_ExB.cpp.
+
+ Particles are injected at the left boundary ( 0 < x < 1 ) every step,
+ drift in +x at E/B = 0.5, and are removed at x > xmax.
+ The pool keeps the active particles dense in its arrays, and is
+ kept in Morton order of 0.5 x 0.5 x 0.5 cells for cache locality.
+ ********************************************************************* */
+
+// ************* initial parameters ************************************
+// number of injected particles per step
+const int ninj = 100;
+// domain
+const double xmax = 20.0;
+// ************* initial parameters ************************************
+
+vector3 E( const vector3& _r ){
+  vector3 _E( 0.0, 0.5, 0.0 );
+  return _E;
+}
+vector3 B( const vector3& _r ){
+  vector3 _B( 0.0, 0.0, 1.0 );
+  return _B;
+}
+vector3 F( const vector3& _r, const vector3& _v,
+           const  double& _t, const  double& _q ){
+  return _q * ( E(_r) + _v * B(_r) );
+}
+
+// escape condition
+struct escaped
+{
+  bool operator()( const ensemble& e, const int& i ){ return e.x[i] > xmax; }
+};
+
+int main()
+{
+  double dt = 0.2;
+  ensemble pool( 100000 );
+  pool.setm(1);
+  pool.setq(1);
+  // source: uniform in 0 < x < 1, isotropic shell |v| = 0.3
+  sampler src( 1 );
+  src.rhi.set( 1.0, 0.0, 0.0 );
+  spatial_sort sorter( vector3(0.0,-16.0,-16.0), vector3(32.0,16.0,16.0), 6 );
+
+  // marching in time
+  for( int i=0; i*dt<100; i++ ){
+    src.t0 = i*dt;
+    src.shell( pool, ninj, 0.3 );
+    pool.rk6(dt); // nonrelativistic motion
+    int nout = pool.remove_if( escaped() );
+    sorter.update( pool );
+    printf( "%f %d %d\n", (i+1)*dt, pool.size(), nout );
+  }
+
+  return 0;
+}
@@ -1,4 +1,5 @@
-#include <particle.h>
+#include <driver.h>
+#include <fields.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
@@ -23,33 +24,50 @@ const double kappa = 0.36178;
 const int np = 256;
 // ************* initial parameters ************************************
 
-// electric field
-vector3 E( const vector3& _r ){
-  vector3 _E( 0.0, 0.0, 0.0 );
-  return _E;
-}
-// magnetic field model
-vector3 B( const vector3& _r ){
-  vector3 _B( _r.z, 0.0, kappa );
-  return _B;
-}
+// field model ( fields.h )
+const sheet_field fld = field_sheet( 1.0, 1.0, 0.0, kappa );
+
+vector3 E( const vector3& _r ){ return fld.E( _r ); }
+vector3 B( const vector3& _r ){ return fld.B( _r ); }
 // force
 vector3 F( const vector3& _r, const vector3& _v,
            const  double& _t, const  double& _q ){
-  return _q * ( E(_r) + _v * B(_r) );
+  return fld.force( _r, _v, _t, _q );
+}
+
+// timestep check: the gyration must be resolved
+struct dtcheck
+{
+  double dt;
+  int operator()( const ensemble& e, const int& i ) const{
+    return event_dtlimit * ( B( e.getr(i) ).abs() * dt > 0.3 );
+  }
+};
+
+// lifecycle of a particle: reports the midplane crossings
+// ( and a too large timestep ) until t = tmax
+lifecycle orbit( agent a )
+{
+  for(;;){
+    event ev = co_await a;
+    if( ev.kind & ( event_cross | event_dtlimit ) ) co_yield ev;
+    if( ev.kind & ( event_tlimit | event_dtlimit ) ) co_return;
+  }
 }
 
 int main()
 {
   double dt = 0.01;
-  particle p, pp, po;
+  particle p;
+  ensemble pool( np );
+  pool.setm(1);
+  pool.setq(1);
+  driver drv( pool );
   srand((unsigned) time(NULL)); // srand() may not be random enough on OSX/gcc
 
   // particle loop
   for( int ip=1; ip<=np; ip++ ){
 
-    fprintf( stderr, "# running %d/%d th particle...\n", ip, np);
-
     // init
     p.sett(0);  p.setm(1);  p.setq(1);
     p.setr(0.0,0.0,0.0);
@@ -76,40 +94,35 @@ int main()
     p.r.x = -(1./kappa)*p.v.y;
     p.r.y = +(1./kappa)*p.v.x;
 
-    // main loop
-    for( int i=0; p.gett()<1000; i++ ){
-
-//       if( i%20 == 0 ){
-//      printf( "%f %f %f %f %f %f %f %f %d\n",
-//              p.gett(),
-//              p.r.x, p.r.y, p.r.z,
-//              p.v.x, p.v.y, p.v.z,
-//              p.v.abs2(), ip );
-//       }
-
-      // midplane crossing
-      if( ( p.r.z * pp.r.z ) < 0.0 ){
-        // linear interpolation
-        // make sure that dt is small enough
-        po.r = ( p.r.z * pp.r - pp.r.z * p.r ) / ( p.r.z - pp.r.z);
-        po.v = ( p.r.z * pp.v - pp.r.z * p.v ) / ( p.r.z - pp.r.z);
-        printf( "%f %f %f %f %f %f %d\n",
-                po.r.x, po.r.y, po.r.z,
-                po.v.x, po.v.y, po.v.z,
-                ip );
-      }
-      pp = p;
-
-      // nonrelativistic motion
-      p.rk4(dt);
-
-      // check the timestep
-      if( ( B(p.r).abs() ) * dt > 0.3 ){
-        fprintf( stderr, "# Exiting ... t = %lf", p.gett() );
-        return -1;
-      }
+    drv.add( p, orbit( drv.self() ) );
+  }
+
+  // all particles are pushed together; nonrelativistic motion
+  drv.h    = dt;
+  drv.step = &ensemble::rk4;  // &ensemble::gl4: |v| is preserved in long runs
+  drv.section = 1;            // midplane z = 0, linear interpolation
+  drv.tmax = 1000;
+  dtcheck check = { dt };
+  long nstep = long( drv.tmax / dt + 0.5 );
+
+#ifndef PPP_STATS
+  fprintf( stderr, "# running %d particles...\n", np );
+#endif
+  for( const event& ev : drv.run( check ) ){
+    if( ev.kind & event_dtlimit ){
+      fprintf( stderr, "# Exiting ... t = %lf", ev.t );
+      return -1;
     }
+    STATS_TIMER( STATS_OUTPUT );
+    printf( "%f %f %f %f %f %f %ld\n",
+            ev.r.x, ev.r.y, ev.r.z,
+            ev.v.x, ev.v.y, ev.v.z,
+            ev.id+1 );
+    // all particles share the time
+    stats_progress( long( ev.t / dt ), nstep, "steps" );
   }
+  stats_progress( nstep, nstep, "steps" );
+  stats_summary( stderr );
 
   return 0;
 }
@@ -1,4 +1,4 @@
-#include <particle.h>
+#include <trajfile.h>
 #include <stdio.h>
 
 // ************* Rossler attractor ************************************
@@ -29,10 +29,16 @@ int main()
           p.r.x + a*p.r.y,
           b + p.r.x*p.r.z - c*p.r.z);
 
+  // full-precision copy of the orbit, see ppt2txt.cpp
+  trajwriter tw;
+  if( tw.open( "data/rossler.ppt", 7 ) < 0 )
+    fprintf( stderr, "# cannot open data/rossler.ppt, not written\n" );
+
   // marching in time
   for( int i=0;p.gett()<=200.001; i++ ){
     printf( "%f %f %f %f %f %f\n",
             p.r.x, p.r.y, p.r.z, p.v.x, p.v.y, p.v.z );
+    tw.write( 0, p );
     p.rk6(0.02); // nonrelativistic motion
   }
 
@@ -0,0 +1,85 @@
+#include <plugin.h>
+#include <sampler.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+/* *********************************************************************
+ Prebuilt driver for force model plugins ( plugin.h ).
+
+   ./sample_sweep plugin_harris.so [ more plugins ... ]
+
+ Each plugin is loaded by dlopen(), and an ensemble of particles
+ ( relativistic, isotropic shell |u| = 0.3 ) is pushed by the
+ blocked RK4 with the batched kernel of the plugin.  The mean
+ kinetic energy and height are written every 10 steps, the cost per
+ particle step to stderr.  New force models need only the plugin to
+ be compiled.
+ ********************************************************************* */
+
+// ************* initial parameters ************************************
+// number of particles
+const int np = 4096;
+// timestep, number of steps
+const double dt = 0.05;
+const int nstep = 1000;
+// ************* initial parameters ************************************
+
+// the kernel of the loaded plugin, also for the scalar steppers
+ppp_force_kernel kernel = 0;
+
+vector3 F( const vector3& _r, const vector3& _v,
+           const  double& _t, const  double& _q ){
+  vector3 f;
+  kernel( 1, &_r.x, &_r.y, &_r.z, &_v.x, &_v.y, &_v.z, &_t, _q,
+          &f.x, &f.y, &f.z );
+  return f;
+}
+
+double now( void )
+{
+  return std::chrono::duration<double>(
+    std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+int main( int argc, char** argv )
+{
+  if( argc < 2 ){
+    fprintf( stderr, "usage: %s plugin.so [ ... ]\n", argv[0] );
+    return 1;
+  }
+  for( int k=1; k<argc; k++ ){
+    plugin pl;
+    if( pl.open( argv[k] ) < 0 ) return 1;
+    kernel = pl.force();
+
+    ensemble e( np );
+    e.setm(1);
+    e.setq(1);
+    e.force = kernel;
+    sampler src( 1 );
+    src.rlo.set( -1.0, -1.0, 2.0 );
+    src.rhi.set(  1.0,  1.0, 3.0 );
+    src.shell( e, np, 0.3 );
+
+    printf( "# %s\n", pl.name() );
+    double t0 = now();
+    for( int i=0; i<=nstep; i++ ){
+      if( i % 10 == 0 ){
+        double ek = 0.0, zm = 0.0;
+        for( int j=0; j<e.size(); j++ ){
+          ek += sqrt( 1.0 + e.getv(j).abs2() ) - 1.0;
+          zm += e.z[j];
+        }
+        printf( "%f %e %f\n", e.t[0], ek/e.size(), zm/e.size() );
+      }
+      if( i < nstep ) e.RK4( dt );
+    }
+    double t1 = now() - t0;
+    printf( "\n\n" );
+    fprintf( stderr, "# %s: %.1f ns per particle step\n", pl.name(),
+             t1 * 1e9 / ( double(np) * nstep ) );
+  }
+
+  return 0;
+}
@@ -0,0 +1,361 @@
+//  -*- C++ -*-
+//  velocity distribution sampler               last updated : 2026/10/19
+
+//
+//  Copyright (C) 2026
+//             Seiji Zenitani <zenitani@gmail.com>
+//
+//  You may copy, use, modify and redistribute this code
+//  for ANY PURPOSE, without significant change, as long as
+//  all copyright notice are retained.
+//  The author provides this code `as is', and declares that
+//  there is no warranty for it.
+//
+//
+// *** History ***
+//
+// 2026/10/19  Ver 0.1   shell, Maxwell, kappa, Maxwell-Juttner
+//
+
+// *** Notice ***
+//
+//   ensemble.h is required.
+//
+//   A sampler appends n particles to an ensemble, with positions
+//   uniform in [rlo,rhi) and velocities from
+//
+//     shell( e, n, v0 )            isotropic, |v| = v0
+//     maxwell( e, n, vth, vd )     exp( -|v-vd|^2/vth^2 )
+//     kappa( e, n, k, th )         ( 1 + v^2/(k th^2) )^-(k+1), k > 3/2
+//     juttner( e, n, th, beta )    Maxwell-Juttner of temperature
+//                                  th = T/mc^2, drifting with the
+//                                  velocity beta ( c = 1 );
+//                                  v is the 4-velocity u, as in RK4()
+//
+//   Random numbers are counter based: the k-th number of a particle
+//   is a hash of ( seed, id, k ), so the result does not depend on
+//   the number of threads.  Loops are OpenMP parallel, and the
+//   uniform, log and sin/cos kernels are branch-free polynomial code
+//   that vectorizes without -ffast-math.  The kappa and Juttner
+//   loaders need a rejection loop for the speed only.
+//
+//   Maxwell-Juttner: Sobol method for th >= 1, a gamma-mixture
+//   envelope for th < 1, and the flipping method for the drift
+//   ( S. Zenitani, Phys. Plasmas 22, 042116 (2015) ).
+
+
+#ifndef _Z_SAMPLER_H_
+#define _Z_SAMPLER_H_
+
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include <vector3.h>
+#include <ensemble.h>
+
+
+// ---- kernels ----
+
+// splitmix64 finalizer
+inline uint64_t ppp_hash( uint64_t x )
+{
+  x += 0x9e3779b97f4a7c15ULL;
+  x = ( x ^ ( x >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+  x = ( x ^ ( x >> 27 ) ) * 0x94d049bb133111ebULL;
+  return x ^ ( x >> 31 );
+}
+
+// uniform in (0,1)
+inline double ppp_uniform( const uint64_t& key, const long& id, const int& k )
+{
+  uint64_t h = ppp_hash( key ^ ( ( (uint64_t) id << 8 ) | (uint64_t) k ) );
+  return ( double( h >> 11 ) + 0.5 ) * 1.1102230246251565e-16;
+}
+
+// natural log of a positive normal number
+inline double ppp_log( const double& x )
+{
+  uint64_t b;
+  double m;
+  memcpy( &b, &x, 8 );
+  double e = double( (long)( b >> 52 ) - 1023 );
+  b = ( b & 0x000fffffffffffffULL ) | 0x3ff0000000000000ULL;
+  memcpy( &m, &b, 8 );
+
+  // m in [ 1/sqrt(2), sqrt(2) )
+  double c = ( m > 1.4142135623730951 ? 1.0 : 0.0 );
+  m *= 1.0 - 0.5*c;
+  e += c;
+
+  // log(m) = 2 atanh(s)
+  double s  = ( m - 1.0 ) / ( m + 1.0 );
+  double s2 = s*s;
+  double p  = 1.0/21.0;
+  p = p*s2 + 1.0/19.0;  p = p*s2 + 1.0/17.0;  p = p*s2 + 1.0/15.0;
+  p = p*s2 + 1.0/13.0;  p = p*s2 + 1.0/11.0;  p = p*s2 + 1.0/9.0;
+  p = p*s2 + 1.0/7.0;   p = p*s2 + 1.0/5.0;   p = p*s2 + 1.0/3.0;
+  p = p*s2 + 1.0;
+  return e * 0.69314718055994530942 + 2.0 * s * p;
+}
+
+// cos and sin of 2 pi ( u - 1/2 ), u in [0,1)
+// by the half angle x in [-pi/2,pi/2) and the double-angle formulas
+inline void ppp_sincos2pi( const double& u, double& sn, double& cs )
+{
+  double x  = 3.14159265358979323846 * ( u - 0.5 );
+  double x2 = x*x;
+  double s  = -1.0/51090942171709440000.0;
+  s = s*x2 + 1.0/121645100408832000.0;  s = s*x2 - 1.0/355687428096000.0;
+  s = s*x2 + 1.0/1307674368000.0;       s = s*x2 - 1.0/6227020800.0;
+  s = s*x2 + 1.0/39916800.0;            s = s*x2 - 1.0/362880.0;
+  s = s*x2 + 1.0/5040.0;                s = s*x2 - 1.0/120.0;
+  s = s*x2 + 1.0/6.0;
+  s = x - x*x2*s;
+  double c  = 1.0/2432902008176640000.0;
+  c = c*x2 - 1.0/6402373705728000.0;    c = c*x2 + 1.0/20922789888000.0;
+  c = c*x2 - 1.0/87178291200.0;         c = c*x2 + 1.0/479001600.0;
+  c = c*x2 - 1.0/3628800.0;             c = c*x2 + 1.0/40320.0;
+  c = c*x2 - 1.0/720.0;                 c = c*x2 + 1.0/24.0;
+  c = c*x2 - 0.5;
+  c = 1.0 + x2*c;
+  sn = 2.0*s*c;
+  cs = c*c - s*s;
+}
+
+// standard normal ( Box-Muller ), uses the numbers k and k+1
+inline double ppp_normal( const uint64_t& key, const long& id, const int& k )
+{
+  double sn, cs;
+  double r = sqrt( -2.0 * ppp_log( ppp_uniform( key, id, k ) ) );
+  ppp_sincos2pi( ppp_uniform( key, id, k+1 ), sn, cs );
+  return r * cs;
+}
+
+
+//
+// sampler class
+//
+
+class sampler
+{
+
+protected:
+  uint64_t key;
+
+  int  begin( ensemble&, const int&, const double& ) const;
+  void isotropic( ensemble&, const int&, const int&, const double* ) const;
+
+public:
+  // positions uniform in [rlo,rhi), time t0
+  vector3 rlo, rhi;
+  double t0;
+
+  // constructor
+  sampler( const unsigned long& = 1 );
+  void setseed( const unsigned long& );
+
+  int shell( ensemble&, const int&, const double& );
+  int maxwell( ensemble&, const int&, const double&,
+               const vector3& = vector3() );
+  int kappa( ensemble&, const int&, const double&, const double& );
+  int juttner( ensemble&, const int&, const double&,
+               const vector3& = vector3() );
+
+};
+
+
+// ---- constructor -----
+
+inline sampler::sampler( const unsigned long& seed )
+  : t0(0.0)
+{
+  setseed( seed );
+  rlo.set();  rhi.set();
+}
+
+inline void sampler::setseed( const unsigned long& seed )
+{
+  key = ppp_hash( seed );
+}
+
+// ---- member functions -----
+
+// appends n particles with positions; numbers 0-2 of each particle
+inline int sampler::begin( ensemble& e, const int& n, const double& _t ) const
+{
+  int i0 = e.append( n );
+  int i1 = e.size();
+  vector3 d = rhi - rlo;
+#pragma omp parallel for
+  for( int i=i0; i<i1; i++ ){
+    e.x[i] = rlo.x + d.x * ppp_uniform( key, e.id[i], 0 );
+    e.y[i] = rlo.y + d.y * ppp_uniform( key, e.id[i], 1 );
+    e.z[i] = rlo.z + d.z * ppp_uniform( key, e.id[i], 2 );
+    e.t[i] = _t;
+  }
+  return i0;
+}
+
+// v = speed[i-i0] times an isotropic direction; numbers 3-4
+inline void sampler::isotropic( ensemble& e, const int& i0, const int& i1,
+                                const double* speed ) const
+{
+#pragma omp parallel for
+  for( int i=i0; i<i1; i++ ){
+    double sn, cs;
+    double mu = 2.0 * ppp_uniform( key, e.id[i], 3 ) - 1.0;
+    double st = sqrt( 1.0 - mu*mu );
+    ppp_sincos2pi( ppp_uniform( key, e.id[i], 4 ), sn, cs );
+    double v = speed[i-i0];
+    e.vx[i] = v * mu;
+    e.vy[i] = v * st * cs;
+    e.vz[i] = v * st * sn;
+  }
+}
+
+// returns the number of appended particles
+inline int sampler::shell( ensemble& e, const int& n, const double& v0 )
+{
+  int i0 = begin( e, n, t0 );
+  int i1 = e.size();
+#pragma omp parallel for
+  for( int i=i0; i<i1; i++ ){
+    double sn, cs;
+    double mu = 2.0 * ppp_uniform( key, e.id[i], 3 ) - 1.0;
+    double st = sqrt( 1.0 - mu*mu );
+    ppp_sincos2pi( ppp_uniform( key, e.id[i], 4 ), sn, cs );
+    e.vx[i] = v0 * mu;
+    e.vy[i] = v0 * st * cs;
+    e.vz[i] = v0 * st * sn;
+  }
+  return i1 - i0;
+}
+
+inline int sampler::maxwell( ensemble& e, const int& n, const double& vth,
+                             const vector3& vd )
+{
+  int i0 = begin( e, n, t0 );
+  int i1 = e.size();
+  double sig = vth * 0.70710678118654752440;
+#pragma omp parallel for
+  for( int i=i0; i<i1; i++ ){
+    double s1, c1, s2, c2;
+    long id = e.id[i];
+    double r1 = sig * sqrt( -2.0 * ppp_log( ppp_uniform( key, id, 3 ) ) );
+    double r2 = sig * sqrt( -2.0 * ppp_log( ppp_uniform( key, id, 4 ) ) );
+    ppp_sincos2pi( ppp_uniform( key, id, 5 ), s1, c1 );
+    ppp_sincos2pi( ppp_uniform( key, id, 6 ), s2, c2 );
+    e.vx[i] = vd.x + r1 * c1;
+    e.vy[i] = vd.y + r1 * s1;
+    e.vz[i] = vd.z + r2 * c2;
+  }
+  return i1 - i0;
+}
+
+// multivariate Student t with 2k-1 degrees of freedom:
+// v = sig Z sqrt( nu/W ), W ~ chi^2_nu = 2 Gamma( nu/2 )
+inline int sampler::kappa( ensemble& e, const int& n, const double& k,
+                           const double& th )
+{
+  int i0 = begin( e, n, t0 );
+  int i1 = e.size();
+  double nu  = 2.0*k - 1.0;
+  double sig = th * sqrt( k / nu );
+  // Marsaglia-Tsang for Gamma( a ), a = nu/2 >= 1
+  double d = 0.5*nu - 1.0/3.0;
+  double c = 1.0 / sqrt( 9.0*d );
+
+#pragma omp parallel for
+  for( int i=i0; i<i1; i++ ){
+    long id = e.id[i];
+    double g = d;
+    for( int j=7; j+2<256; j+=3 ){
+      double x = ppp_normal( key, id, j );
+      double v = 1.0 + c*x;
+      if( v <= 0.0 ) continue;
+      v = v*v*v;
+      double u = ppp_uniform( key, id, j+2 );
+      if( ppp_log(u) < 0.5*x*x + d - d*v + d*ppp_log(v) ){ g = d*v; break; }
+    }
+    double f = sig * sqrt( nu / ( 2.0*g ) );
+
+    double s1, c1, s2, c2;
+    double r1 = f * sqrt( -2.0 * ppp_log( ppp_uniform( key, id, 3 ) ) );
+    double r2 = f * sqrt( -2.0 * ppp_log( ppp_uniform( key, id, 4 ) ) );
+    ppp_sincos2pi( ppp_uniform( key, id, 5 ), s1, c1 );
+    ppp_sincos2pi( ppp_uniform( key, id, 6 ), s2, c2 );
+    e.vx[i] = r1 * c1;
+    e.vy[i] = r1 * s1;
+    e.vz[i] = r2 * c2;
+  }
+  return i1 - i0;
+}
+
+inline int sampler::juttner( ensemble& e, const int& n, const double& th,
+                             const vector3& beta )
+{
+  int i0 = begin( e, n, t0 );
+  int i1 = e.size();
+  double* speed = new double[ i1 - i0 ];
+
+  // gamma-mixture envelope of u^2 exp(-(gamma-1)/th) du, th < 1:
+  // (1+eps) sqrt(eps(eps+2)) <= sqrt(2) (1 + 5eps/4 + eps^2/4) sqrt(eps)
+  double w1 = 1.0, w2 = 1.875*th, w3 = 0.9375*th*th;
+  double ws = w1 + w2 + w3;
+  w1 /= ws;  w2 = w1 + w2/ws;
+
+#pragma omp parallel for
+  for( int i=i0; i<i1; i++ ){
+    long id = e.id[i];
+    double u = 0.0;
+    if( th >= 1.0 ){
+      // Sobol
+      for( int j=8; j+4<=256; j+=4 ){
+        double x123 = ppp_uniform( key, id, j ) * ppp_uniform( key, id, j+1 )
+          * ppp_uniform( key, id, j+2 );
+        u = -th * ppp_log( x123 );
+        double eta = -th * ppp_log( x123 * ppp_uniform( key, id, j+3 ) );
+        if( eta*eta - u*u > 1.0 ) break;
+      }
+    }else{
+      for( int j=8; j+7<=256; j+=7 ){
+        double m  = ppp_uniform( key, id, j );
+        double z  = ppp_normal( key, id, j+1 );
+        double ep = 0.5*z*z - ppp_log( ppp_uniform( key, id, j+3 ) );
+        if( m >= w1 ) ep -= ppp_log( ppp_uniform( key, id, j+4 ) );
+        if( m >= w2 ) ep -= ppp_log( ppp_uniform( key, id, j+5 ) );
+        ep *= th;
+        u = sqrt( ep * ( ep + 2.0 ) );
+        double acc = sqrt( 0.5 * ( ep + 2.0 ) ) / ( 1.0 + 0.25*ep );
+        if( ppp_uniform( key, id, j+6 ) < acc ) break;
+      }
+    }
+    speed[i-i0] = u;
+  }
+  isotropic( e, i0, i1, speed );
+  delete [] speed;
+
+  // drift: flipping method and Lorentz boost along beta
+  double b = beta.abs();
+  if( b > 0.0 ){
+    vector3 nb = beta / b;
+    double G = 1.0 / sqrt( 1.0 - b*b );
+#pragma omp parallel for
+    for( int i=i0; i<i1; i++ ){
+      double ux = e.vx[i], uy = e.vy[i], uz = e.vz[i];
+      double g  = sqrt( 1.0 + ux*ux + uy*uy + uz*uz );
+      double up = ux*nb.x + uy*nb.y + uz*nb.z;
+      double f  = ( -b*up > g * ppp_uniform( key, e.id[i], 5 ) ? -2.0*up : 0.0 );
+      up += f;
+      double dp = G * ( up + b*g ) - ( up - f );
+      e.vx[i] = ux + dp * nb.x;
+      e.vy[i] = uy + dp * nb.y;
+      e.vz[i] = uz + dp * nb.z;
+    }
+  }
+  return i1 - i0;
+}
+
+# endif
+
+// end
@@ -0,0 +1,234 @@
+//  -*- C++ -*-
+//  spatial sorting of particle ensembles       last updated : 2026/10/19
+
+//
+//  Copyright (C) 2026
+//             Seiji Zenitani <zenitani@gmail.com>
+//
+//  You may copy, use, modify and redistribute this code
+//  for ANY PURPOSE, without significant change, as long as
+//  all copyright notice are retained.
+//  The author provides this code `as is', and declares that
+//  there is no warranty for it.
+//
+//
+// *** History ***
+//
+// 2026/10/19  Ver 0.1   Morton-order counting sort
+//
+
+// *** Notice ***
+//
+//   ensemble.h is required.
+//
+//   spatial_sort reorders an ensemble along the Morton (Z-order)
+//   curve of a grid of 2^nbits x 2^nbits x 2^nbits cells in the box
+//   [lo,hi), nbits <= 7 ( every thread keeps a histogram of all cells,
+//   8 MB at nbits = 7 ).  Particles outside the box are counted in the
+//   edge cells.
+//   Inside a cell, the previous order is kept ( stable sort ).
+//
+//   sort( e )    sorts now, by a parallel counting sort over cells
+//   update( e )  call every step; every `interval' calls the cell keys
+//                are checked, and the ensemble is sorted only if more
+//                than `tolerance' of the neighbours are out of order.
+//                Returns 1 if sorted.
+
+
+#ifndef _Z_SORTING_H_
+#define _Z_SORTING_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <vector3.h>
+#include <ensemble.h>
+
+
+//
+// spatial sorting class
+//
+
+class spatial_sort
+{
+
+protected:
+  vector3 lo, scale;
+  int nbits, ncell, count;
+  int nbuf, nhist;
+  int *key, *perm, *hist;
+  double* buf;
+
+  // not copyable
+  spatial_sort( const spatial_sort& );
+  spatial_sort& operator = ( const spatial_sort& );
+
+  void reserve( const int& );
+  void keys( const ensemble& );
+  void order( ensemble& );
+  template< class T >
+  void permute( T*, const int& );
+
+public:
+  int interval;
+  double tolerance;
+
+  // constructor
+  spatial_sort( const vector3&, const vector3&, const int& );
+  ~spatial_sort( void );
+
+  int  cell( const double&, const double&, const double& ) const;
+  void sort( ensemble& );
+  int  update( ensemble& );
+
+};
+
+
+// ---- Morton code ----
+
+// spreads the lower 10 bits of i to every third bit
+inline unsigned int morton_spread( unsigned int i )
+{
+  i &= 0x000003ff;
+  i = ( i | ( i << 16 ) ) & 0x030000ff;
+  i = ( i | ( i <<  8 ) ) & 0x0300f00f;
+  i = ( i | ( i <<  4 ) ) & 0x030c30c3;
+  i = ( i | ( i <<  2 ) ) & 0x09249249;
+  return i;
+}
+
+
+// ---- constructor -----
+
+// 1 <= nbits <= 7 per dimension
+inline spatial_sort::spatial_sort( const vector3& _lo, const vector3& _hi,
+                                   const int& _nbits )
+  : lo(_lo), nbits( _nbits < 1 ? 1 : ( _nbits > 7 ? 7 : _nbits ) ),
+    count(0), nbuf(0), nhist(0),
+    key(0), perm(0), hist(0), buf(0), interval(20), tolerance(0.1)
+{
+  double nc = double( 1 << nbits );
+  scale.set( nc/(_hi.x-_lo.x), nc/(_hi.y-_lo.y), nc/(_hi.z-_lo.z) );
+  ncell = 1 << ( 3*nbits );
+}
+
+inline spatial_sort::~spatial_sort( void )
+{
+  free( key );  free( perm );  free( buf );  free( hist );
+}
+
+// ---- member functions -----
+
+inline void spatial_sort::reserve( const int& n )
+{
+  if( n <= nbuf ) return;
+  nbuf = n;
+  key  = (int*)    realloc( key,  sizeof(int) * n );
+  perm = (int*)    realloc( perm, sizeof(int) * n );
+  buf  = (double*) realloc( buf,  sizeof(double) * n );
+}
+
+inline int spatial_sort::cell( const double& _x, const double& _y,
+                               const double& _z ) const
+{
+  // clamped before the conversion ( NaN goes to 0 )
+  double cmax = double( ( 1 << nbits ) - 1 );
+  double fx = ( _x - lo.x ) * scale.x;
+  double fy = ( _y - lo.y ) * scale.y;
+  double fz = ( _z - lo.z ) * scale.z;
+  int ix = int( fx >= 0.0 ? ( fx < cmax ? fx : cmax ) : 0.0 );
+  int iy = int( fy >= 0.0 ? ( fy < cmax ? fy : cmax ) : 0.0 );
+  int iz = int( fz >= 0.0 ? ( fz < cmax ? fz : cmax ) : 0.0 );
+  return int( morton_spread(ix) | ( morton_spread(iy) << 1 )
+              | ( morton_spread(iz) << 2 ) );
+}
+
+inline void spatial_sort::keys( const ensemble& e )
+{
+  int n = e.size();
+  reserve( n );
+#pragma omp parallel for
+  for( int i=0; i<n; i++ ) key[i] = cell( e.x[i], e.y[i], e.z[i] );
+}
+
+template< class T >
+inline void spatial_sort::permute( T* a, const int& n )
+{
+  T* tmp = (T*) buf;
+#pragma omp parallel for
+  for( int i=0; i<n; i++ ) tmp[i] = a[perm[i]];
+  memcpy( a, tmp, sizeof(T) * n );
+}
+
+// parallel counting sort of the current keys:
+// per-thread histograms, prefix sum, scatter
+inline void spatial_sort::order( ensemble& e )
+{
+  int n = e.size();
+
+  // one histogram per thread of the coming parallel region
+  int ntmax = ppp_max_threads();
+  if( ntmax > nhist ){
+    nhist = ntmax;
+    hist = (int*) realloc( hist, sizeof(int) * ncell * nhist );
+  }
+
+#pragma omp parallel
+  {
+    int nt = ppp_num_threads();
+    int it = ppp_thread_num();
+    int i0 = int( (long) n *  it    / nt );
+    int i1 = int( (long) n * (it+1) / nt );
+    int* h = hist + (long) it * ncell;
+    int i, c, k;
+
+    for( c=0; c<ncell; c++ ) h[c] = 0;
+    for( i=i0; i<i1; i++ ) h[key[i]]++;
+
+#pragma omp barrier
+#pragma omp single
+    {
+      int sum = 0;
+      for( c=0; c<ncell; c++ ){
+        for( k=0; k<nt; k++ ){
+          int tmp = hist[ (long) k * ncell + c ];
+          hist[ (long) k * ncell + c ] = sum;
+          sum += tmp;
+        }
+      }
+    }
+
+    for( i=i0; i<i1; i++ ) perm[ h[key[i]]++ ] = i;
+  }
+
+  permute( e.x,  n );  permute( e.y,  n );  permute( e.z,  n );
+  permute( e.vx, n );  permute( e.vy, n );  permute( e.vz, n );
+  permute( e.t,  n );  permute( e.id, n );
+}
+
+inline void spatial_sort::sort( ensemble& e )
+{
+  keys( e );
+  order( e );
+}
+
+inline int spatial_sort::update( ensemble& e )
+{
+  if( ++count < interval ) return 0;
+  count = 0;
+
+  int n = e.size();
+  if( n < 2 ) return 0;
+  keys( e );
+  int disorder = 0;
+#pragma omp parallel for reduction(+:disorder)
+  for( int i=1; i<n; i++ ) disorder += ( key[i] < key[i-1] );
+
+  if( disorder <= tolerance * n ) return 0;
+  order( e );
+  return 1;
+}
+
+# endif
+
+// end
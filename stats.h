@@ -0,0 +1,243 @@
+//  -*- C++ -*-
+//  runtime instrumentation                     last updated : 2026/10/19
+
+//
+//  Copyright (C) 2026
+//             Seiji Zenitani <zenitani@gmail.com>
+//
+//  You may copy, use, modify and redistribute this code
+//  for ANY PURPOSE, without significant change, as long as
+//  all copyright notice are retained.
+//  The author provides this code `as is', and declares that
+//  there is no warranty for it.
+//
+//
+// *** History ***
+//
+// 2026/10/19  Ver 0.1   force-call counters, step histograms, timers
+//
+
+// *** Notice ***
+//
+//   Instrumentation is enabled by compiling with -DPPP_STATS.
+//   Otherwise all macros expand to nothing and the functions are empty.
+//
+//   STATS_STEP( nf, h )  one step of size h with nf force evaluations
+//   STATS_FORCE( nf )    nf force evaluations outside a step
+//   STATS_REJECT()       one rejected step ( of an adaptive stepper )
+//   STATS_NOCONV()       one implicit step whose iteration did not
+//                        converge
+//   STATS_SWITCH()       one change of mode ( guiding center <==>
+//                        full orbit )
+//   STATS_TIMER( ph )    charge the enclosing scope to the phase ph:
+//                        STATS_PUSH    pushes
+//                        STATS_FIELD   the force stage of the blocked
+//                                      pushes, and the field gathers of
+//                                      guiding_center.h
+//                        STATS_EVENT   stop conditions of driver.h
+//                        STATS_OUTPUT  output
+//   stats_progress( done, total, unit )   progress line, at most once
+//                                   a second, in particles by default
+//                                   ( serialized, callable from threads )
+//   stats_summary( fp )             merged summary of all threads
+//
+//   A timer costs two clock reads, so it is never put around a single
+//   F() call: the F() calls of the particle.h steppers count as the
+//   enclosing phase, and only their number is recorded.
+//
+//   Every thread owns its counters, so the hot path is a plain
+//   increment.  The counters are linked into a global list when a
+//   thread first touches them, and merged by stats_summary().
+//   Nested timers are exclusive: an inner phase pauses the outer one.
+
+
+#ifndef _Z_STATS_H_
+#define _Z_STATS_H_
+
+#include <stdio.h>
+
+enum { STATS_OTHER, STATS_PUSH, STATS_FIELD, STATS_EVENT, STATS_OUTPUT,
+       STATS_NPHASE };
+
+
+#ifdef PPP_STATS
+
+#include <math.h>
+#include <chrono>
+#include <mutex>
+
+// histogram of log2|h|, bins from 2^-32 to 2^31
+const int stats_nbin = 64;
+const int stats_bin0 = 32;
+
+struct stats_counter
+{
+  long nforce, nstep, nreject, nnoconv, nswitch;
+  long hist[stats_nbin];
+  double time[STATS_NPHASE];
+  int phase;
+  std::chrono::steady_clock::time_point t0;
+  stats_counter* next;
+};
+
+inline std::mutex& stats_mutex( void )
+{
+  static std::mutex mtx;
+  return mtx;
+}
+inline stats_counter*& stats_head( void )
+{
+  static stats_counter* head = 0;
+  return head;
+}
+inline std::chrono::steady_clock::time_point& stats_start( void )
+{
+  static std::chrono::steady_clock::time_point t =
+    std::chrono::steady_clock::now();
+  return t;
+}
+
+// counters are never freed, so that exited threads still count
+inline stats_counter* stats_register( void )
+{
+  stats_counter* c = new stats_counter();
+  c->phase = STATS_OTHER;
+  c->t0 = std::chrono::steady_clock::now();
+  std::lock_guard<std::mutex> lock( stats_mutex() );
+  stats_start();
+  c->next = stats_head();
+  stats_head() = c;
+  return c;
+}
+
+inline stats_counter& stats_local( void )
+{
+  thread_local stats_counter* c = stats_register();
+  return *c;
+}
+
+inline void stats_step( const int& nf, const double& h )
+{
+  stats_counter& c = stats_local();
+  int e;
+  frexp( h, &e );
+  e += stats_bin0;
+  if( e < 0 ) e = 0;
+  if( e >= stats_nbin ) e = stats_nbin-1;
+  c.nforce += nf;
+  c.nstep++;
+  c.hist[e]++;
+}
+
+inline void stats_force( const int& nf ){ stats_local().nforce += nf; }
+inline void stats_reject( void ){ stats_local().nreject++; }
+inline void stats_noconv( void ){ stats_local().nnoconv++; }
+inline void stats_switch( void ){ stats_local().nswitch++; }
+
+// exclusive phase timer
+class stats_timer
+{
+  stats_counter& c;
+  int prev;
+
+  void charge( void ){
+    std::chrono::steady_clock::time_point now =
+      std::chrono::steady_clock::now();
+    c.time[c.phase] += std::chrono::duration<double>( now - c.t0 ).count();
+    c.t0 = now;
+  }
+
+public:
+  stats_timer( const int& ph ) : c( stats_local() ), prev( c.phase ){
+    charge();  c.phase = ph;
+  }
+  ~stats_timer( void ){
+    charge();  c.phase = prev;
+  }
+};
+
+inline double stats_elapsed( void )
+{
+  return std::chrono::duration<double>
+    ( std::chrono::steady_clock::now() - stats_start() ).count();
+}
+
+inline void stats_progress( const long& done, const long& total,
+                            const char* unit = "particles" )
+{
+  static double last = -1.0;
+  std::lock_guard<std::mutex> lock( stats_mutex() );
+  double el = stats_elapsed();
+  if( el - last < 1.0 && done < total ) return;
+  last = el;
+
+  double rate = ( el > 0.0 ? done / el : 0.0 );
+  double eta  = ( rate > 0.0 ? ( total - done ) / rate : 0.0 );
+  fprintf( stderr, "# %ld/%ld %s, %.1f %s/s, eta %.0f s\n",
+           done, total, unit, rate, unit, eta );
+}
+
+inline void stats_summary( FILE* fp )
+{
+  static const char* name[STATS_NPHASE] =
+    { "other", "push", "field", "event", "output" };
+  long nforce=0, nstep=0, nreject=0, nnoconv=0, nswitch=0;
+  long hist[stats_nbin];
+  double time[STATS_NPHASE];
+  int i, nthread=0;
+
+  for( i=0; i<stats_nbin; i++ ) hist[i] = 0;
+  for( i=0; i<STATS_NPHASE; i++ ) time[i] = 0.0;
+
+  std::lock_guard<std::mutex> lock( stats_mutex() );
+  for( stats_counter* c = stats_head(); c; c = c->next ){
+    nthread++;
+    nforce  += c->nforce;
+    nstep   += c->nstep;
+    nreject += c->nreject;
+    nnoconv += c->nnoconv;
+    nswitch += c->nswitch;
+    for( i=0; i<stats_nbin; i++ ) hist[i] += c->hist[i];
+    for( i=0; i<STATS_NPHASE; i++ ) time[i] += c->time[i];
+  }
+
+  fprintf( fp, "# ---- statistics : %d thread(s), %.3f s ----\n",
+           nthread, stats_elapsed() );
+  fprintf( fp, "# force calls %ld, steps %ld, rejected %ld, not converged %ld\n",
+           nforce, nstep, nreject, nnoconv );
+  fprintf( fp, "# mode switches %ld\n", nswitch );
+  for( i=0; i<STATS_NPHASE; i++ )
+    fprintf( fp, "# time %-6s %12.6f s\n", name[i], time[i] );
+  for( i=0; i<stats_nbin; i++ )
+    if( hist[i] > 0 )
+      fprintf( fp, "# |h| in [2^%d,2^%d) : %ld\n",
+               i-stats_bin0-1, i-stats_bin0, hist[i] );
+}
+
+#define STATS_STEP(nf,h)    stats_step( (nf), (h) )
+#define STATS_FORCE(nf)     stats_force( (nf) )
+#define STATS_REJECT()      stats_reject()
+#define STATS_NOCONV()      stats_noconv()
+#define STATS_SWITCH()      stats_switch()
+#define STATS_CAT_(a,b)     a##b
+#define STATS_CAT(a,b)      STATS_CAT_(a,b)
+#define STATS_TIMER(ph)     stats_timer STATS_CAT(_stats_timer_,__LINE__)( ph )
+
+#else
+
+inline void stats_progress( const long&, const long&,
+                            const char* = "particles" ){}
+inline void stats_summary( FILE* ){}
+
+#define STATS_STEP(nf,h)
+#define STATS_FORCE(nf)
+#define STATS_REJECT()
+#define STATS_NOCONV()
+#define STATS_SWITCH()
+#define STATS_TIMER(ph)
+
+#endif
+
+# endif
+
+// end
@@ -0,0 +1,164 @@
+//  -*- C++ -*-
+//  trajectory replay buffer                    last updated : 2026/10/19
+
+//
+//  Copyright (C) 2026
+//             Seiji Zenitani <zenitani@gmail.com>
+//
+//  You may copy, use, modify and redistribute this code
+//  for ANY PURPOSE, without significant change, as long as
+//  all copyright notice are retained.
+//  The author provides this code `as is', and declares that
+//  there is no warranty for it.
+//
+//
+// *** History ***
+//
+// 2026/10/19  Ver 0.1   ring buffer with recomputation checkpoints
+//
+
+// *** Notice ***
+//
+//   particle.h is required.
+//
+//   A trajectory records the states ( t, r, v ) of one particle,
+//   typically during a backward integration, so that the same
+//   segment can be replayed forward ( or in any order ) without
+//   integrating it again.
+//
+//   trajectory tr( nmax, stride, &particle::rk6, h );
+//   record( p )  call before every step; step number 0, 1, 2, ...
+//   get( j, p )  restores step j into p ( first() <= j <= last() )
+//
+//   Memory is bounded: the ring keeps the latest nmax checkpoints and
+//   drops the oldest.  With stride > 1 only every stride-th step is
+//   stored; get() recomputes the steps between two checkpoints with
+//   the stepper and timestep given to the constructor, which must be
+//   the ones used in recording, and keeps that segment in a cache, so
+//   a sweep over the buffer integrates each step at most once more.
+//   Without a stepper every step is stored ( stride = 1 ).
+//   p must have m and q of the recorded particle.
+
+
+#ifndef _Z_TRAJECTORY_H_
+#define _Z_TRAJECTORY_H_
+
+#include <stdlib.h>
+#include <vector3.h>
+#include <particle.h>
+
+
+//
+// trajectory class
+//
+
+class trajectory
+{
+
+protected:
+  struct state {
+    double t;
+    vector3 r, v;
+  };
+
+  int nmax, stride;
+  long nrec, segk;
+  state *buf, *seg;
+  void (particle::*step)( const double& );
+  double h;
+
+  // not copyable
+  trajectory( const trajectory& );
+  trajectory& operator = ( const trajectory& );
+
+  static void save( state&, const particle& );
+  static void restore( const state&, particle& );
+
+public:
+  // constructor
+  trajectory( const int&, const int& = 1,
+              void (particle::*)( const double& ) = 0, const double& = 0.0 );
+  ~trajectory( void );
+
+  void clear( void );
+  void record( const particle& );
+
+  long first( void ) const;
+  long last( void ) const;
+  void get( const long&, particle& );
+
+};
+
+
+// ---- constructor -----
+
+// without a stepper, nothing can be recomputed
+inline trajectory::trajectory( const int& _nmax, const int& _stride,
+                               void (particle::*_step)( const double& ),
+                               const double& _h )
+  : nmax(_nmax), stride( _step ? _stride : 1 ), nrec(0), segk(-1),
+    step(_step), h(_h)
+{
+  buf = (state*) malloc( sizeof(state) * nmax );
+  seg = (state*) malloc( sizeof(state) * stride );
+}
+
+inline trajectory::~trajectory( void ){ free( buf ); free( seg ); }
+
+// ---- member functions -----
+
+inline void trajectory::save( state& s, const particle& p )
+{
+  s.t = p.gett();  s.r = p.r;  s.v = p.v;
+}
+inline void trajectory::restore( const state& s, particle& p )
+{
+  p.sett( s.t );  p.r = s.r;  p.v = s.v;
+}
+
+inline void trajectory::clear( void ){ nrec = 0; segk = -1; }
+
+inline void trajectory::record( const particle& p )
+{
+  long k = nrec / stride;
+  if( nrec % stride == 0 ) save( buf[ k % nmax ], p );
+  // the cached segment grows
+  if( segk == k ) segk = -1;
+  nrec++;
+}
+
+// the oldest and the latest step in the buffer
+inline long trajectory::first( void ) const
+{
+  long nck = ( nrec + stride-1 ) / stride;
+  return ( nck > nmax ? nck - nmax : 0 ) * stride;
+}
+inline long trajectory::last( void ) const{ return nrec - 1; }
+
+inline void trajectory::get( const long& j, particle& p )
+{
+  long k = j / stride;
+  int  o = int( j % stride );
+
+  if( o == 0 ){
+    restore( buf[ k % nmax ], p );
+    return;
+  }
+
+  // recompute the segment after checkpoint k
+  if( segk != k ){
+    int i;
+    restore( buf[ k % nmax ], p );
+    save( seg[0], p );
+    for( i=1; i<stride && k*stride+i <= last(); i++ ){
+      (p.*step)( h );
+      save( seg[i], p );
+    }
+    segk = k;
+  }
+  restore( seg[o], p );
+}
+
+# endif
+
+// end
@@ -0,0 +1,608 @@
+//  -*- C++ -*-
+//  compressed trajectory files                 last updated : 2026/10/19
+
+//
+//  Copyright (C) 2026
+//             Seiji Zenitani <zenitani@gmail.com>
+//
+//  You may copy, use, modify and redistribute this code
+//  for ANY PURPOSE, without significant change, as long as
+//  all copyright notice are retained.
+//  The author provides this code `as is', and declares that
+//  there is no warranty for it.
+//
+//
+// *** History ***
+//
+// 2026/10/19  Ver 0.1   chunked predictive coding, chunk index
+//
+
+// *** Notice ***
+//
+//   particle.h is required.
+//
+//   A trajectory file stores records ( id, t, ... ) of nvar doubles,
+//   rec[0] = t, in full double precision.  The records of each
+//   particle are buffered and written in chunks of up to `chunk'
+//   records, column by column.  Each value is predicted by polynomial
+//   extrapolation of the previous values of its column ( order 0-4,
+//   chosen per column and chunk ), and the XOR residual is stored in
+//   its non-zero low bytes after a 4-bit byte count, as in FPC
+//   ( M. Burtscher and P. Ratanaworabhan, IEEE Trans. Comput. 58, 18
+//   (2009) ).  Evenly spaced times cost half a byte.
+//
+//   quantize( k, eps ) stores the column k with an absolute error
+//   <= eps instead, as the residuals of the integers round( x/2eps ).
+//   eps is one per file, so it must be set before the first write().
+//
+//   The chunk index at the end of the file gives random access by
+//   particle and time:
+//
+//     trajreader rd;
+//     rd.open( "data/rossler.ppt" );
+//     rd.seek( id, t0, t1 );          // optional filter
+//     while( rd.next( id, rec ) > 0 ) ...  // streaming, one chunk
+//                                           // in memory; -1 on a
+//                                           // truncated file
+//
+//   Files are in the native byte order.  The writer keeps one buffer
+//   of chunk*nvar doubles per particle.
+
+
+#ifndef _Z_TRAJFILE_H_
+#define _Z_TRAJFILE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <particle.h>
+
+
+// ---- coding kernels ----
+
+const char trajfile_magic[4] = { 'P', 'P', 'P', 'T' };
+const int  trajfile_version = 1;
+
+// maximum order of the extrapolation
+const int trajfile_order = 4;
+
+// number of non-zero low bytes
+inline int ppp_nbytes( const uint64_t& r )
+{
+  if( r == 0 ) return 0;
+#if defined(__GNUC__)
+  return 8 - __builtin_clzll( r ) / 8;
+#else
+  int n = 8;
+  while( ( r >> ( 8*n - 8 ) ) == 0 ) n--;
+  return n;
+#endif
+}
+
+inline uint64_t ppp_bits( const double& x )
+{
+  uint64_t b;
+  memcpy( &b, &x, 8 );
+  return b;
+}
+inline double ppp_double( const uint64_t& b )
+{
+  double x;
+  memcpy( &x, &b, 8 );
+  return x;
+}
+
+// history of a column and its extrapolations of order 0 ... 4,
+// by sums of backward differences: only additions, so that the
+// encoder and the decoder round the same way ( no FMA contraction )
+template< class T >
+struct trajfile_history
+{
+  T h[ trajfile_order+1 ];
+
+  void init( void ){
+    for( int j=0; j<=trajfile_order; j++ ) h[j] = 0;
+  }
+  void predict( T* p ) const{
+    T a[ trajfile_order+1 ];
+    int i, j;
+    for( i=0; i<=trajfile_order; i++ ) a[i] = h[i];
+    p[0] = a[0];
+    for( j=1; j<=trajfile_order; j++ ){
+      for( i=0; i<=trajfile_order-j; i++ ) a[i] = a[i] - a[i+1];
+      p[j] = p[j-1] + a[0];
+    }
+  }
+  void update( const T& x ){
+    for( int j=trajfile_order; j>0; j-- ) h[j] = h[j-1];
+    h[0] = x;
+  }
+};
+
+// one column: XOR residuals of the bits, or for a quantized column
+// ( eps > 0 ) zigzag residuals of the integers round( x/2eps )
+struct trajfile_column
+{
+  double eps2, inv;
+  trajfile_history<double>  hx;
+  trajfile_history<int64_t> hk;
+
+  void init( const double& eps ){
+    eps2 = 2.0*eps;
+    inv  = ( eps > 0.0 ? 1.0/eps2 : 0.0 );
+    hx.init();
+    hk.init();
+  }
+
+  // residuals of x for every order
+  void residuals( const double& x, uint64_t* r ) const{
+    if( eps2 > 0.0 ){
+      int64_t k = llround( x * inv ), p[ trajfile_order+1 ];
+      hk.predict( p );
+      for( int j=0; j<=trajfile_order; j++ ){
+        int64_t d = k - p[j];
+        r[j] = ( (uint64_t) d << 1 ) ^ (uint64_t)( d >> 63 );
+      }
+    }else{
+      double p[ trajfile_order+1 ];
+      hx.predict( p );
+      for( int j=0; j<=trajfile_order; j++ ) r[j] = ppp_bits( x ) ^ ppp_bits( p[j] );
+    }
+  }
+
+  // value from the residual r of order j
+  double value( const uint64_t& r, const int& j ) const{
+    if( eps2 > 0.0 ){
+      int64_t p[ trajfile_order+1 ];
+      hk.predict( p );
+      int64_t d = (int64_t)( r >> 1 ) ^ -(int64_t)( r & 1 );
+      return double( p[j] + d ) * eps2;
+    }
+    double p[ trajfile_order+1 ];
+    hx.predict( p );
+    return ppp_double( r ^ ppp_bits( p[j] ) );
+  }
+
+  void update( const double& x ){
+    if( eps2 > 0.0 ) hk.update( llround( x * inv ) );
+    else             hx.update( x );
+  }
+};
+
+// chunk index entry
+struct trajfile_chunk
+{
+  long id;
+  double t0, t1;
+  long offset;
+  int nrec, size;
+};
+
+
+//
+// trajwriter class
+//
+
+class trajwriter
+{
+
+protected:
+  struct stream {
+    long id;
+    int nrec;
+    double* rec;
+  };
+
+  FILE* fp;
+  int nvar, chunk;
+  double* eps;
+  long offset;
+
+  // open-addressing table of the particle buffers
+  int nslot, nused;
+  stream* slot;
+
+  int nindex, nimax;
+  trajfile_chunk* index;
+
+  unsigned char* buf;
+  int nbuf;
+
+  // not copyable
+  trajwriter( const trajwriter& );
+  trajwriter& operator = ( const trajwriter& );
+
+  stream* find( const long& );
+  void flush( stream& );
+
+public:
+  // constructor
+  trajwriter( void );
+  ~trajwriter( void );
+
+  int  open( const char*, const int&, const int& = 1024 );
+  int  quantize( const int&, const double& );
+  int  write( const long&, const double* );
+  int  write( const long&, const particle& );
+  void close( void );
+
+};
+
+
+//
+// trajreader class
+//
+
+class trajreader
+{
+
+protected:
+  FILE* fp;
+  int nvar, chunk;
+  double* eps;
+  long nchunk;
+  trajfile_chunk* index;
+
+  // the decoded chunk and the filter
+  long ic;
+  int irec;
+  double* dec;
+  unsigned char* buf;
+  int nbuf;
+  long fid;
+  double ft0, ft1;
+
+  // not copyable
+  trajreader( const trajreader& );
+  trajreader& operator = ( const trajreader& );
+
+  int  load( const long& );
+
+public:
+  // constructor
+  trajreader( void );
+  ~trajreader( void );
+
+  int  open( const char* );
+  void close( void );
+
+  int  getnvar( void ) const;
+  long getnchunk( void ) const;
+  const trajfile_chunk& getchunk( const long& ) const;
+
+  void seek( const long& = -1, const double& = -HUGE_VAL,
+             const double& = HUGE_VAL );
+  int  next( long&, double* );
+
+};
+
+
+// ---- chunk coding ----
+
+// chunk layout: the order of each column ( nvar bytes ), the number
+// of residual bytes of each value ( 4 bits ), the residual bytes
+
+// encodes nrec records ( rec[ i*nvar + k ] ) into out, returns the size;
+// out needs nvar*( nrec*8.5 + 1 ) + 1 bytes
+inline int trajfile_encode( const double* rec, const int& nrec,
+                            const int& nvar, const double* eps,
+                            unsigned char* out )
+{
+  int nval = nrec * nvar;
+  unsigned char* ord  = out;
+  unsigned char* code = out + nvar;
+  unsigned char* res  = code + ( nval + 1 ) / 2;
+  int iv = 0;
+  trajfile_column c;
+  uint64_t r[ trajfile_order+1 ];
+
+  memset( code, 0, ( nval + 1 ) / 2 );
+  for( int k=0; k<nvar; k++ ){
+    // the order with the fewest bytes
+    long nb[ trajfile_order+1 ] = { 0 };
+    int i, j, best = 0;
+    c.init( eps[k] );
+    for( i=0; i<nrec; i++ ){
+      c.residuals( rec[ i*nvar + k ], r );
+      for( j=0; j<=trajfile_order; j++ ) nb[j] += ppp_nbytes( r[j] );
+      c.update( rec[ i*nvar + k ] );
+    }
+    for( j=1; j<=trajfile_order; j++ ) if( nb[j] < nb[best] ) best = j;
+    ord[k] = (unsigned char) best;
+
+    c.init( eps[k] );
+    for( i=0; i<nrec; i++, iv++ ){
+      c.residuals( rec[ i*nvar + k ], r );
+      int n = ppp_nbytes( r[best] );
+      code[ iv/2 ] |= (unsigned char)( n << 4*( iv & 1 ) );
+      for( int b=0; b<n; b++ ) *res++ = (unsigned char)( r[best] >> 8*b );
+      c.update( rec[ i*nvar + k ] );
+    }
+  }
+  return int( res - out );
+}
+
+inline void trajfile_decode( const unsigned char* in, const int& nrec,
+                             const int& nvar, const double* eps, double* rec )
+{
+  int nval = nrec * nvar;
+  const unsigned char* ord  = in;
+  const unsigned char* code = in + nvar;
+  const unsigned char* res  = code + ( nval + 1 ) / 2;
+  int iv = 0;
+  trajfile_column c;
+
+  for( int k=0; k<nvar; k++ ){
+    c.init( eps[k] );
+    for( int i=0; i<nrec; i++, iv++ ){
+      int n = ( code[ iv/2 ] >> 4*( iv & 1 ) ) & 15;
+      uint64_t r = 0;
+      for( int b=0; b<n; b++ ) r |= (uint64_t)( *res++ ) << 8*b;
+      double x = c.value( r, ord[k] );
+      rec[ i*nvar + k ] = x;
+      c.update( x );
+    }
+  }
+}
+
+
+// ---- trajwriter -----
+
+inline trajwriter::trajwriter( void )
+  : fp(0), nvar(0), chunk(0), eps(0), offset(0), nslot(0), nused(0),
+    slot(0), nindex(0), nimax(0), index(0), buf(0), nbuf(0) {}
+
+inline trajwriter::~trajwriter( void ){ close(); }
+
+// nvar doubles per record, rec[0] = t; returns -1 on failure
+inline int trajwriter::open( const char* file, const int& _nvar,
+                             const int& _chunk )
+{
+  close();
+  fp = fopen( file, "wb" );
+  if( !fp ) return -1;
+  nvar  = _nvar;
+  chunk = _chunk;
+  eps   = (double*) calloc( nvar, sizeof(double) );
+  nbuf  = nvar * ( chunk * 9 + 1 ) + 1;
+  buf   = (unsigned char*) malloc( nbuf );
+  nslot = 64;
+  slot  = (stream*) calloc( nslot, sizeof(stream) );
+  for( int i=0; i<nslot; i++ ) slot[i].id = -1;
+  // header; eps is rewritten at close()
+  fwrite( trajfile_magic, 1, 4, fp );
+  fwrite( &trajfile_version, sizeof(int), 1, fp );
+  fwrite( &nvar,  sizeof(int), 1, fp );
+  fwrite( &chunk, sizeof(int), 1, fp );
+  fwrite( eps, sizeof(double), nvar, fp );
+  offset = 16 + 8*nvar;
+  return 0;
+}
+
+// before the first write(); eps = 0 for lossless.  returns -1 if
+// records were written already or k is not a column
+inline int trajwriter::quantize( const int& k, const double& _eps )
+{
+  if( !fp || nused > 0 || k < 0 || k >= nvar ) return -1;
+  eps[k] = _eps;
+  return 0;
+}
+
+// ids >= 0
+inline trajwriter::stream* trajwriter::find( const long& id )
+{
+  if( 2*( nused+1 ) > nslot ){
+    // rehash into a table twice as large
+    int n0 = nslot;
+    stream* s0 = slot;
+    nslot *= 2;
+    slot = (stream*) calloc( nslot, sizeof(stream) );
+    for( int i=0; i<nslot; i++ ) slot[i].id = -1;
+    for( int i=0; i<n0; i++ ){
+      if( s0[i].id < 0 ) continue;
+      unsigned long h = (unsigned long) s0[i].id * 0x9e3779b97f4a7c15UL;
+      int j = int( h % nslot );
+      while( slot[j].id >= 0 ) j = ( j+1 ) % nslot;
+      slot[j] = s0[i];
+    }
+    free( s0 );
+  }
+  unsigned long h = (unsigned long) id * 0x9e3779b97f4a7c15UL;
+  int j = int( h % nslot );
+  while( slot[j].id >= 0 && slot[j].id != id ) j = ( j+1 ) % nslot;
+  if( slot[j].id < 0 ){
+    slot[j].id   = id;
+    slot[j].nrec = 0;
+    slot[j].rec  = (double*) malloc( sizeof(double) * nvar * chunk );
+    nused++;
+  }
+  return &slot[j];
+}
+
+inline void trajwriter::flush( stream& s )
+{
+  if( s.nrec == 0 ) return;
+  int size = trajfile_encode( s.rec, s.nrec, nvar, eps, buf );
+  fwrite( buf, 1, size, fp );
+
+  if( nindex >= nimax ){
+    nimax = ( nimax > 0 ? 2*nimax : 256 );
+    index = (trajfile_chunk*) realloc( index, sizeof(trajfile_chunk) * nimax );
+  }
+  trajfile_chunk& c = index[nindex++];
+  c.id = s.id;
+  c.t0 = s.rec[0];
+  c.t1 = s.rec[ (s.nrec-1) * nvar ];
+  if( c.t0 > c.t1 ){ double tmp = c.t0;  c.t0 = c.t1;  c.t1 = tmp; }
+  c.offset = offset;
+  c.nrec = s.nrec;
+  c.size = size;
+  offset += size;
+  s.nrec = 0;
+}
+
+// nothing is written unless open() succeeded; returns -1 then
+inline int trajwriter::write( const long& id, const double* rec )
+{
+  if( !fp ) return -1;
+  stream* s = find( id );
+  memcpy( s->rec + s->nrec * nvar, rec, sizeof(double) * nvar );
+  if( ++s->nrec == chunk ) flush( *s );
+  return 0;
+}
+
+// t, r, v; returns -1 unless nvar = 7
+inline int trajwriter::write( const long& id, const particle& p )
+{
+  if( nvar != 7 ) return -1;
+  double rec[7] = { p.gett(), p.r.x, p.r.y, p.r.z, p.v.x, p.v.y, p.v.z };
+  return write( id, rec );
+}
+
+inline void trajwriter::close( void )
+{
+  if( !fp ) return;
+  for( int i=0; i<nslot; i++ ){
+    if( slot[i].id < 0 ) continue;
+    flush( slot[i] );
+    free( slot[i].rec );
+  }
+  fwrite( index, sizeof(trajfile_chunk), nindex, fp );
+  long n = nindex;
+  fwrite( &offset, sizeof(long), 1, fp );
+  fwrite( &n, sizeof(long), 1, fp );
+  fwrite( trajfile_magic, 1, 4, fp );
+  fseek( fp, 16, SEEK_SET );
+  fwrite( eps, sizeof(double), nvar, fp );
+  fclose( fp );
+  fp = 0;
+  free( eps );  free( slot );  free( index );  free( buf );
+  eps = 0;  slot = 0;  index = 0;  buf = 0;
+  nslot = nused = nindex = nimax = 0;
+}
+
+
+// ---- trajreader -----
+
+inline trajreader::trajreader( void )
+  : fp(0), nvar(0), chunk(0), eps(0), nchunk(0), index(0), ic(0), irec(0),
+    dec(0), buf(0), nbuf(0), fid(-1), ft0(-HUGE_VAL), ft1(HUGE_VAL) {}
+
+inline trajreader::~trajreader( void ){ close(); }
+
+// returns -1 if the file is missing or not a trajectory file
+inline int trajreader::open( const char* file )
+{
+  char magic[4];
+  int ver;
+  long off;
+
+  close();
+  fp = fopen( file, "rb" );
+  if( !fp ) return -1;
+  if( fread( magic, 1, 4, fp ) != 4 || memcmp( magic, trajfile_magic, 4 )
+      || fread( &ver, sizeof(int), 1, fp ) != 1 || ver != trajfile_version
+      || fread( &nvar, sizeof(int), 1, fp ) != 1
+      || fread( &chunk, sizeof(int), 1, fp ) != 1 ){
+    close();
+    return -1;
+  }
+  eps = (double*) malloc( sizeof(double) * nvar );
+  if( fread( eps, sizeof(double), nvar, fp ) != (size_t) nvar ){
+    close();
+    return -1;
+  }
+  // footer and index
+  fseek( fp, -(long)( 2*sizeof(long) + 4 ), SEEK_END );
+  if( fread( &off, sizeof(long), 1, fp ) != 1
+      || fread( &nchunk, sizeof(long), 1, fp ) != 1
+      || fread( magic, 1, 4, fp ) != 4 || memcmp( magic, trajfile_magic, 4 ) ){
+    close();
+    return -1;
+  }
+  index = (trajfile_chunk*) malloc( sizeof(trajfile_chunk) * ( nchunk + 1 ) );
+  fseek( fp, off, SEEK_SET );
+  if( fread( index, sizeof(trajfile_chunk), nchunk, fp ) != (size_t) nchunk ){
+    close();
+    return -1;
+  }
+  nbuf = nvar * ( chunk * 9 + 1 ) + 1;
+  buf  = (unsigned char*) malloc( nbuf );
+  dec  = (double*) malloc( sizeof(double) * nvar * chunk );
+  seek();
+  return 0;
+}
+
+inline void trajreader::close( void )
+{
+  if( fp ) fclose( fp );
+  fp = 0;
+  free( eps );  free( index );  free( buf );  free( dec );
+  eps = 0;  index = 0;  buf = 0;  dec = 0;
+  nvar = 0;  chunk = 0;  nchunk = 0;
+}
+
+inline int  trajreader::getnvar( void ) const{ return nvar; }
+inline long trajreader::getnchunk( void ) const{ return nchunk; }
+inline const trajfile_chunk& trajreader::getchunk( const long& i ) const
+{
+  return index[i];
+}
+
+// restarts the stream, with the records of particle id ( -1: all )
+// and t0 <= t <= t1 only
+inline void trajreader::seek( const long& id, const double& t0,
+                              const double& t1 )
+{
+  fid = id;  ft0 = t0;  ft1 = t1;
+  ic = -1;
+  irec = 0;
+}
+
+// returns -1 if the chunk is cut short or does not fit the buffers
+inline int trajreader::load( const long& i )
+{
+  const trajfile_chunk& c = index[i];
+  fseek( fp, c.offset, SEEK_SET );
+  if( c.size < 0 || c.size > nbuf || c.nrec < 0 || c.nrec > chunk
+      || fread( buf, 1, c.size, fp ) != (size_t) c.size ){
+    fprintf( stderr, "trajreader: chunk %ld ( particle %ld ) is damaged\n",
+             i, c.id );
+    return -1;
+  }
+  trajfile_decode( buf, c.nrec, nvar, eps, dec );
+  return 0;
+}
+
+// the next record; returns 0 at the end, -1 on a read error ( which
+// also ends the stream )
+inline int trajreader::next( long& id, double* rec )
+{
+  for(;;){
+    if( ic >= nchunk ) return 0;
+    if( ic < 0 || irec >= index[ic].nrec ){
+      // the next chunk that passes the filter
+      do ic++;
+      while( ic < nchunk && ( ( fid >= 0 && index[ic].id != fid )
+                              || index[ic].t1 < ft0 || index[ic].t0 > ft1 ) );
+      if( ic >= nchunk ) return 0;
+      if( load( ic ) < 0 ){
+        ic = nchunk;
+        return -1;
+      }
+      irec = 0;
+    }
+    const double* r = dec + (long) irec * nvar;
+    irec++;
+    if( r[0] < ft0 || r[0] > ft1 ) continue;
+    id = index[ic].id;
+    memcpy( rec, r, sizeof(double) * nvar );
+    return 1;
+  }
+}
+
+# endif
+
+// end
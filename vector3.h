@@ -1,5 +1,5 @@
 //  -*- C++ -*-
-//  3-dimensional vector class                last updated : 2018/07/28
+//  3-dimensional vector class                last updated : 2026/10/19
 
 //
 //  Copyright (C) 1998-2001, 2018
@@ -17,6 +17,9 @@
 // 1998/09/05  Ver 0.1   project started
 // 1999/03/10  Ver 1.0   stable release
 // 2000/03/06      1.1   relativistic functions
+// 2026/10/19      1.2   all functions inline ( ODR-clean ),
+//                       trivially copyable, fused madd() and set(),
+//                       fused stage sums
 // 
 
 
@@ -37,7 +40,7 @@ public:
   vector3( const int&, const int&, const int& );
 
   // operators
-  vector3& operator  = ( const vector3& );
+  //   copy and assignment are implicit ( trivially copyable )
   vector3& operator += ( const vector3& );
   vector3& operator -= ( const vector3& );
   vector3& operator *= ( const double& );
@@ -75,8 +78,15 @@ public:
   void set( const double&, const double&, const double& );
   void set( const int&, const int&, const int& );
   void set( void );
+  void set( const vector3&, const double&, const vector3& );
+  void set( const vector3&, const double&, const double*, const vector3*,
+            const int& );
   void reset( void );
 
+  // fused operations without temporaries
+  vector3& madd( const double&, const vector3& );
+  vector3& madd( const double&, const double*, const vector3*, const int& );
+
   double abs( void ) const;
   double abs2( void ) const;
   double gamma( void ) const;
@@ -94,23 +104,16 @@ public:
 
 // ---- constructor ----
 
-vector3::vector3( void )
+inline vector3::vector3( void )
   : x( 0.0 ), y( 0.0 ), z( 0.0 ) {}
-vector3::vector3( const double& _x, const double& _y, const double& _z )
+inline vector3::vector3( const double& _x, const double& _y, const double& _z )
   : x( _x ), y( _y ), z( _z ) {}
-vector3::vector3( const int& _x, const int& _y, const int& _z )
+inline vector3::vector3( const int& _x, const int& _y, const int& _z )
   : x(double(_x)), y(double(_y)), z(double(_z)) {}
 
 
 // ----  operators ------
 
-// unary operators
-inline vector3& vector3::operator = ( const vector3& v )
-{
-  x = v.x ; y = v.y ; z = v.z ;
-  return *this;
-}
-
 // assign operators
 inline vector3& vector3::operator += ( const vector3& v )
 {
@@ -232,16 +235,47 @@ inline vector3 operator / ( const vector3& v, const int& i )
 
 // ---- member functions ------
 
-void vector3::set( const double& _x, const double& _y, const double& _z )
+inline void vector3::set( const double& _x, const double& _y, const double& _z )
 {
   x = _x ; y = _y ; z = _z ;
 }
-void vector3::set( const int& _x, const int& _y, const int& _z )
+inline void vector3::set( const int& _x, const int& _y, const int& _z )
 {
   x = (double)_x ; y = (double)_y ; z = (double)_z ;
 }
-void vector3::set( void ){   x = 0.0 ; y = 0.0 ; z = 0.0 ; }
-void vector3::reset( void ){ x = 0.0 ; y = 0.0 ; z = 0.0 ; }
+inline void vector3::set( void ){   x = 0.0 ; y = 0.0 ; z = 0.0 ; }
+inline void vector3::reset( void ){ x = 0.0 ; y = 0.0 ; z = 0.0 ; }
+
+// *this = a + d*b
+inline void vector3::set( const vector3& a, const double& d, const vector3& b )
+{
+  x = a.x + d*b.x ; y = a.y + d*b.y ; z = a.z + d*b.z ;
+}
+// *this += d*b
+inline vector3& vector3::madd( const double& d, const vector3& b )
+{
+  x += d*b.x ; y += d*b.y ; z += d*b.z ;
+  return *this;
+}
+
+// Runge-Kutta stage sums in one pass, n >= 1:
+// *this = a + h * ( d[0]*b[0] + ... + d[n-1]*b[n-1] )
+inline void vector3::set( const vector3& a, const double& h, const double* d,
+                          const vector3* b, const int& n )
+{
+  double sx = d[0]*b[0].x, sy = d[0]*b[0].y, sz = d[0]*b[0].z;
+  for( int j=1; j<n; j++ ){
+    sx += d[j]*b[j].x ; sy += d[j]*b[j].y ; sz += d[j]*b[j].z ;
+  }
+  x = a.x + h*sx ; y = a.y + h*sy ; z = a.z + h*sz ;
+}
+// *this += h * ( d[0]*b[0] + ... + d[n-1]*b[n-1] )
+inline vector3& vector3::madd( const double& h, const double* d,
+                               const vector3* b, const int& n )
+{
+  set( *this, h, d, b, n );
+  return *this;
+}
 
 inline double vector3::abs2( void ) const
 {
@@ -273,15 +307,15 @@ inline vector3 vector3::uv2v( void ) const
 
 // ---- useful functions ------
 
-vector3 cross( const vector3& a, const vector3& b )
+inline vector3 cross( const vector3& a, const vector3& b )
 {
   return( a * b );
 }
-double dot( const vector3& a, const vector3& b )
+inline double dot( const vector3& a, const vector3& b )
 {
   return( a % b );
 }
-double abs( const vector3& v )
+inline double abs( const vector3& v )
 {
   return( v.abs() );
 }